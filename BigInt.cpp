@@ -6,7 +6,7 @@
  * 
  *  This is the implementation of the header "BigInt.h", providing
  *   basic big-integer computation functions. The data is stored
- *   as binary in unsigned char arrays.
+ *   as binary in arrays of 64-bit limbs.
  * ----------------------------------------------------------------
  */
 
@@ -14,1026 +14,3820 @@
 #include "BigInt.h"
 #include "internal_util.h"
 
-BigInt::BigInt()
-{
-	this->byteLen = this->numLen = 0;
-	this->number = nullptr;
-	this->isNegative = false;
-}
+// Bits in a limb.
+#define LIMB_BITS 64
 
-BigInt::BigInt(const int _byteLen, void* dummy)
+#ifdef __SIZEOF_INT128__
+typedef unsigned __int128 dlimb_t;
+#endif
+
+// Multiplies two limbs, returns the lower limb of the product and stores the higher one in <hi>.
+static inline limb_t mulLimbs(limb_t a, limb_t b, limb_t& hi)
 {
-	this->byteLen = _byteLen;
-	this->numLen = 0;
-	this->number = allocZerosMem(this->byteLen);
-	this->isNegative = false;
+#ifdef __SIZEOF_INT128__
+	dlimb_t prod = (dlimb_t)a * b;
+	hi = (limb_t)(prod >> LIMB_BITS);
+	return (limb_t)prod;
+#else
+	// Schoolbook on 32-bit halves when the compiler has no 128-bit type.
+	limb_t aLo = a & 0xFFFFFFFFULL, aHi = a >> 32;
+	limb_t bLo = b & 0xFFFFFFFFULL, bHi = b >> 32;
+	limb_t ll = aLo * bLo, lh = aLo * bHi, hl = aHi * bLo, hh = aHi * bHi;
+	limb_t mid = (ll >> 32) + (lh & 0xFFFFFFFFULL) + (hl & 0xFFFFFFFFULL);
+	hi = hh + (lh >> 32) + (hl >> 32) + (mid >> 32);
+	return (mid << 32) | (ll & 0xFFFFFFFFULL);
+#endif
 }
 
-// "void* copy" is just a dummy indicating this constructor is called.
-BigInt::BigInt(unsigned char* _num, bool _isNeg, int _len, void* copy = nullptr)
+// Divides the double limb [hi:lo] by <d>, which MUST be greater than <hi>. Returns the quotient and stores the remainder in <rem>.
+static inline limb_t divLimbs(limb_t hi, limb_t lo, limb_t d, limb_t& rem)
 {
-	this->byteLen = this->numLen = _len;
-	for(int i = _len - 1 ; i >= 0 ; i--)
+#ifdef __SIZEOF_INT128__
+	dlimb_t num = ((dlimb_t)hi << LIMB_BITS) | lo;
+	rem = (limb_t)(num % d);
+	return (limb_t)(num / d);
+#else
+	// Knuth's algorithm D on 32-bit halves, see "Hacker's Delight" (divlu).
+	int s = 0;
+	while(!(d & (1ULL << 63)))
 	{
-		if(_num[i] != 0)
+		d <<= 1;
+		s++;
+	}
+	if(s)
+	{
+		hi = (hi << s) | (lo >> (LIMB_BITS - s));
+		lo <<= s;
+	}
+	limb_t dHi = d >> 32, dLo = d & 0xFFFFFFFFULL;
+	limb_t lHi = lo >> 32, lLo = lo & 0xFFFFFFFFULL;
+	
+	limb_t q1 = hi / dHi, r = hi - q1 * dHi;
+	while(q1 >> 32 || q1 * dLo > ((r << 32) | lHi))
+	{
+		q1--;
+		r += dHi;
+		if(r >> 32)
 		{
 			break;
 		}
-		this->numLen--;
 	}
-	this->number = _num;
-	this->isNegative = _isNeg;
-}
-
-BigInt::BigInt(const char* _num, bool _isNeg, int _len)
-{
-	for(int i = _len - 1 ; i >= 0 ; i--)
+	limb_t mid = (hi << 32) + lHi - q1 * d;
+	
+	limb_t q0 = mid / dHi;
+	r = mid - q0 * dHi;
+	while(q0 >> 32 || q0 * dLo > ((r << 32) | lLo))
 	{
-		if(_num[i] != 0)
+		q0--;
+		r += dHi;
+		if(r >> 32)
 		{
 			break;
 		}
-		_len--;
 	}
-	this->byteLen = this->numLen = _len;
-	this->number = new unsigned char[this->byteLen];
-	
-	// Just like "strcpy()", but copies whatever inside the specified length, including zeros.
-	memcpy(this->number, _num, this->byteLen);
-	this->isNegative = _isNeg;
+	rem = ((mid << 32) + lLo - q0 * d) >> s;
+	return (q1 << 32) | q0;
+#endif
 }
 
-BigInt::BigInt(const BigInt& copyFrom)
+// Counts the leading zero bits of a non-zero limb.
+static inline int countLeadingZeros(limb_t x)
 {
-	this->byteLen = this->numLen = copyFrom.numLen;
-	this->number = new unsigned char[this->byteLen];
-	memcpy(this->number, copyFrom.number, this->byteLen);
-	this->isNegative = copyFrom.isNegative;
+#if defined(__GNUC__) || defined(__clang__)
+	return __builtin_clzll(x);
+#else
+	int n = 0;
+	while(!(x & (1ULL << 63)))
+	{
+		x <<= 1;
+		n++;
+	}
+	return n;
+#endif
 }
 
-BigInt::~BigInt()
+// Number of the trailing zero bits of a non-zero limb.
+static inline int countTrailingZeros(limb_t x)
+{
+#if defined(__GNUC__) || defined(__clang__)
+	return __builtin_ctzll(x);
+#else
+	int n = 0;
+	while(!(x & 1))
+	{
+		x >>= 1;
+		n++;
+	}
+	return n;
+#endif
+}
+
+// Capacity (in limbs) for a limb array outgrowing <capacity> to hold <needed> limbs. It's at least doubled,
+//  so that a value growing bit by bit is moved only a logarithmic number of times.
+static inline int grownCapacity(int capacity, int needed)
 {
-	delete [] this->number;
+	return (needed > 2 * capacity) ? needed : 2 * capacity;
 }
 
-int BigInt::getByteLength() const
+// The bit of a limb array at the given position, counted from the least significant one.
+static inline int limbBit(const limb_t* num, int bit)
 {
-	return this->byteLen;
+	return (int)((num[bit / LIMB_BITS] >> (bit % LIMB_BITS)) & 1);
 }
 
-// This WILL NOT copy the input data!
-void BigInt::setValues(unsigned char* newNumber, int newByteLen, bool newNegative)
+// Length of the limb array without the leading zero(s).
+static inline int trimmedLen(const limb_t* num, int len)
 {
-	delete [] this->number;
-	this->number = newNumber;
-	this->byteLen = newByteLen;
-	this->isNegative = newNegative;
-	
-	for(int i = (this->byteLen - 1) ; i >= 0 ; i--)
+	while(len > 0 && num[len - 1] == 0)
 	{
-		if(this->number[i] != 0)
-		{
-			this->numLen = i + 1;
-			return;
-		}
+		len--;
 	}
-	this->numLen = 0;
+	return len;
 }
 
-void BigInt::byteWiseAdditionNoCopy(const unsigned char* cand1, int len1, const unsigned char* cand2, int len2, unsigned char* ret, int bLenOut)
+// The reciprocal of a normalized limb <d> (with it's highest bit set), floor((2^128 - 1) / d) - 2^64.
+static inline limb_t limbReciprocal(limb_t d)
 {
-	unsigned short cache = 0;
-	cache = 0;
-	
-	// Pointing to the lower byte in the short "cache".
-	unsigned char *cPtr = castPtr<unsigned char>(&cache);
-	
-	int i;
-	for(i = 0 ; i < len2 ; i++)
-	{
-		cache += cand1[i];
-		cache += cand2[i];
-		ret[i] = *cPtr;
-		// The carry (higher byte in the "cache") of this partial addition should be added into the next byte.
-		cache >>= 8;
-	}
-	
-	for(i = len2 ; i < len1 ; i++)
-	{
-		cache += cand1[i];
-		ret[i] = *cPtr;
-		// The carry (higher byte in the "cache") of this partial addition should be added into the next byte.
-		cache >>= 8;
-	}
+	limb_t rem;
+	return divLimbs(~d, ~0ULL, d, rem);
+}
+
+// Divides the double limb [hi:lo] by the normalized limb <d> with it's reciprocal <inv>, where <d> MUST be
+//  greater than <hi>. Returns the quotient and stores the remainder in <rem>. See Moller and Granlund,
+//  "Improved division by invariant integers", Algorithm 4, which takes two multiplications and no division.
+static inline limb_t divLimbsPreinv(limb_t hi, limb_t lo, limb_t d, limb_t inv, limb_t& rem)
+{
+	limb_t qHi, qLo = mulLimbs(inv, hi, qHi);
+	qLo += lo;
+	qHi += hi + 1 + (qLo < lo);
 	
-	if(bLenOut > len1)
+	// The first adjustment is hard to predict, so it's done with a mask instead of a branch.
+	limb_t r = lo - qHi * d;
+	limb_t mask = 0 - (limb_t)(r > qLo);
+	qHi += mask;
+	r += mask & d;
+	if(r >= d)
 	{
-		ret[len1] = *cPtr;
+		qHi++;
+		r -= d;
 	}
+	rem = r;
+	return qHi;
 }
 
-unsigned char* BigInt::byteWiseAddition(const unsigned char* cand1, int len1, const unsigned char* cand2, int len2, int& bLenOut)
+// The largest power of ten which fits into a limb, and its exponent.
+static const limb_t TEN_POW_19 = 10000000000000000000ULL;
+static const int TEN_POW_19_DIGITS = 19;
+
+// Candidates shorter than this (in limbs) are multiplied by the schoolbook method instead of Karatsuba.
+#ifndef KARATSUBA_THRESHOLD
+#define KARATSUBA_THRESHOLD 32
+#endif
+
+// Balanced candidates at least this long (in limbs) are multiplied by Toom-3 instead of Karatsuba.
+#ifndef TOOM3_THRESHOLD
+#define TOOM3_THRESHOLD 128
+#endif
+
+// The shorter of two unbalanced candidates must be at least this long (in limbs) to use Toom-2.5.
+#ifndef TOOM32_THRESHOLD
+#define TOOM32_THRESHOLD 64
+#endif
+
+// The shorter candidate must be at least this long (in limbs) to be multiplied by number-theoretic transforms.
+#ifndef NTT_THRESHOLD
+#define NTT_THRESHOLD 2048
+#endif
+
+// Values at least this long (in limbs) have their square roots found by Newton's iteration instead of bit by bit.
+#ifndef SQRT_NEWTON_THRESHOLD
+#define SQRT_NEWTON_THRESHOLD 2
+#endif
+
+// Values at least this long (in limbs) are converted into decimal by splitting them with powers of ten.
+#ifndef DECIMAL_SPLIT_THRESHOLD
+#define DECIMAL_SPLIT_THRESHOLD 32
+#endif
+
+// Divisors at least this long (in limbs) are divided by the recursive method instead of Algorithm D.
+#ifndef RECURSIVE_DIVISION_THRESHOLD
+#define RECURSIVE_DIVISION_THRESHOLD 64
+#endif
+
+// Values at least this long (in limbs) have their GCD reduced by the half-GCD instead of Lehmer's steps alone.
+#ifndef HALF_GCD_THRESHOLD
+#define HALF_GCD_THRESHOLD 256
+#endif
+
+// Each limb array from allocLimbArray() is preceded by a header of two limbs, holding the allocator it came
+//  from (nullptr for "new") and it's length including the header.
+#define LIMB_ARRAY_HEADER 2
+
+// Number of freed arrays a BigIntPool keeps for each size class.
+#ifndef POOL_KEPT_PER_CLASS
+#define POOL_KEPT_PER_CLASS 16
+#endif
+
+static thread_local BigIntAllocator* installedAllocator = nullptr;
+
+BigIntAllocator* BigIntAllocator::install(BigIntAllocator* allocator)
 {
-	bool lenComp = (len1 > len2);
-	bLenOut = (lenComp ? len1 : len2) + 1;
-	unsigned char *ret = new unsigned char[bLenOut];
-	if(lenComp)
-	{
-		byteWiseAdditionNoCopy(cand1, len1, cand2, len2, ret, bLenOut);
-	}
-	else
-	{
-		byteWiseAdditionNoCopy(cand2, len2, cand1, len1, ret, bLenOut);
-	}
-	return ret;
+	BigIntAllocator* previous = installedAllocator;
+	installedAllocator = allocator;
+	return previous;
 }
 
-void BigInt::byteWiseNegationNoCopy(const unsigned char* cand1, int len1, const unsigned char* cand2, int len2, unsigned char* ret, int bLenOut)
+BigIntAllocator* BigIntAllocator::installed()
 {
-	unsigned short cache = 0;
-	
-	// Pointing to the lower byte in the short "cache".
-	unsigned char *cPtr = castPtr<unsigned char>(&cache);
-	char temp = 0;
+	return installedAllocator;
+}
 
-	int i;
-	// The input is made sure that cand1 > cand2 is always true.
-	for(i = 0 ; i < len2 ; i++)
-	{
-		cache = cand1[i] - cache;
-		cache -= cand2[i];
-		ret[i] = *cPtr;
-		
-		// The carry (higher byte in the "cache") of this partial addition should be added into the next byte.
-		// In this case, the "extra 1" that has to be negated in the next byte.
-		*cPtr = 0x100 - (cache >>= 8);
-	}
-	
-	for(i = len2 ; i < len1 ; i++)
+// The size class of BigIntPool for arrays of <len> limbs.
+static inline int poolClass(int len)
+{
+	int c = 0;
+	while(c < BIGINT_POOL_CLASSES && (1 << c) < len)
 	{
-		cache = cand1[i] - cache;
-		ret[i] = *cPtr;
-		
-		// The carry (higher byte in the "cache") of this partial addition should be added into the next byte.
-		// In this case, the "extra 1" that has to be negated in the next byte.
-		*cPtr = 0x100 - (cache >>= 8);
+		c++;
 	}
+	return c;
 }
 
-unsigned char* BigInt::byteWiseNegation(const unsigned char* cand1, int len1, const unsigned char* cand2, int len2, int& bLenOut)
+BigIntPool::BigIntPool()
 {
-	bLenOut = len1;
-	unsigned char *ret = new unsigned char[bLenOut];
-	byteWiseNegationNoCopy(cand1, len1, cand2, len2, ret, bLenOut);
-	
-	return ret;
+	memset(this->freeLists, 0, sizeof(this->freeLists));
+	memset(this->freeCounts, 0, sizeof(this->freeCounts));
 }
 
-bool BigInt::byteWiseGreater(const unsigned char* cand1, const unsigned char* cand2, int len, bool equal = false)
+BigIntPool::~BigIntPool()
 {
-	for(int i = len - 1 ; i >= 0 ; i--)
+	for(int c = 0 ; c < BIGINT_POOL_CLASSES ; c++)
 	{
-		if(cand1[i] > cand2[i])
-		{
-			return true;
-		}
-		else if(cand1[i] < cand2[i])
+		while(this->freeLists[c] != nullptr)
 		{
-			return false;
+			limb_t* space = this->freeLists[c];
+			this->freeLists[c] = *reinterpret_cast<limb_t**>(space);
+			delete [] space;
 		}
 	}
-	
-	// Equal.
-	return equal;
 }
 
-bool BigInt::absGreater(const BigInt& comp) const
+limb_t* BigIntPool::allocate(int len)
 {
-	if(this->numLen == comp.numLen)
+	int c = poolClass(len);
+	if(c == BIGINT_POOL_CLASSES)
 	{
-		return byteWiseGreater(this->number, comp.number, this->numLen);
+		return new limb_t[len];
 	}
-	else
+	
+	limb_t* space = this->freeLists[c];
+	if(space == nullptr)
 	{
-		return (this->numLen > comp.numLen);
+		return new limb_t[1 << c];
 	}
+	this->freeLists[c] = *reinterpret_cast<limb_t**>(space);
+	this->freeCounts[c]--;
+	return space;
 }
 
-unsigned char* BigInt::shiftBits(int offset, const unsigned char* cand1, int len1, int& bLenOut)
+void BigIntPool::release(limb_t* space, int len)
 {
-	unsigned char *ret = nullptr;
-	if(offset > 0)
-	{
-		int offBytes = offset / 8;
-		int offBits = offset % 8;
-		int offBitsCompliment = 8 - offBits;
-		bLenOut = len1 + offBytes + 1;
-	
-		ret = allocZerosMem(bLenOut);
-		for(int i = 0 ; i < len1 ; i++)
-		{
-			ret[i + offBytes] += cand1[i] << offBits;
-			ret[i + offBytes + 1] = cand1[i] >> offBitsCompliment; // The "head" of the byte after that is "carried" to this byte.
-		}
-	}
-	else if(offset < 0)
-	{
-		offset = -offset;
-		int offBytes = offset / 8;
-		int offBits = offset % 8;
-		int offBitsCompliment = 8 - offBits;
-		bLenOut = len1 - offBytes;
-		ret = new unsigned char[bLenOut];
-		for(int i = offBytes ; i < len1 - 1 ; i++)
-		{
-			ret[i - offBytes] = (cand1[i] >> offBits) + (cand1[i + 1] << offBitsCompliment);
-		}
-		ret[len1 - offBytes - 1] = (cand1[len1 - 1] >> offBits);
-	}
-	else // offset == 0 is only used in division processing.
+	int c = poolClass(len);
+	if(c == BIGINT_POOL_CLASSES || this->freeCounts[c] >= POOL_KEPT_PER_CLASS)
 	{
-		bLenOut = len1 + 1;
-		ret = new unsigned char[bLenOut];
-		ret[len1] = 0;
-		memcpy(ret, cand1, len1);
+		delete [] space;
+		return;
 	}
-	return ret;
+	*reinterpret_cast<limb_t**>(space) = this->freeLists[c];
+	this->freeLists[c] = space;
+	this->freeCounts[c]++;
 }
 
-unsigned char* BigInt::allocZerosMem(int _len)
+BigIntPool& BigIntPool::forThisThread()
 {
-	unsigned char* ret = new unsigned char[_len];
-	memset(ret, 0, _len);
-	return ret;
+	static thread_local BigIntPool pool;
+	return pool;
 }
 
-const BigInt& BigInt::operator=(const BigInt& copyFrom)
+BigIntArena::BigIntArena(int initialLen)
 {
-	if(this == &copyFrom)
+	this->chunks = nullptr;
+	this->next = this->end = nullptr;
+	this->chunkLen = (initialLen > 2) ? initialLen : 2;
+	this->previous = BigIntAllocator::install(this);
+}
+
+BigIntArena::~BigIntArena()
+{
+	BigIntAllocator::install(this->previous);
+	while(this->chunks != nullptr)
 	{
-		return *this;
+		limb_t* chunk = this->chunks;
+		this->chunks = *reinterpret_cast<limb_t**>(chunk);
+		delete [] chunk;
 	}
-	
-	if(this->byteLen != copyFrom.numLen)
+}
+
+limb_t* BigIntArena::allocate(int len)
+{
+	if(this->end - this->next < len)
 	{
-		delete [] this->number;
-		this->byteLen = this->numLen = copyFrom.numLen;
-		this->number = new unsigned char[this->byteLen];
+		// The first limb of a chunk links to the previous one.
+		while(this->chunkLen - 1 < len)
+		{
+			this->chunkLen *= 2;
+		}
+		limb_t* chunk = new limb_t[this->chunkLen];
+		*reinterpret_cast<limb_t**>(chunk) = this->chunks;
+		this->chunks = chunk;
+		this->next = chunk + 1;
+		this->end = chunk + this->chunkLen;
+		this->chunkLen *= 2;
 	}
 	
-	memcpy(this->number, copyFrom.number, this->byteLen);
-	this->isNegative = copyFrom.isNegative;
-	
-	return *this;
+	limb_t* space = this->next;
+	this->next += len;
+	return space;
 }
 
-const BigInt BigInt::operator-() const
+void BigIntArena::release(limb_t* space, int len)
 {
-	BigInt ret(*this);
-	ret.isNegative = !(this->isNegative);
-	return ret;
+	if(space + len == this->next)
+	{
+		this->next = space;
+	}
 }
 
-const BigInt BigInt::abs() const
+BigInt BigIntArena::keep(const BigInt& value)
 {
-	BigInt ret(*this);
-	ret.isNegative = false;
+	// The copy takes it's space from whatever is installed, so the previous allocator is put back for it.
+	BigIntAllocator::install(this->previous);
+	BigInt ret(value);
+	BigIntAllocator::install(this);
 	return ret;
 }
 
-const BigInt BigInt::operator+(const BigInt& addi) const
+// Scratch limbs of each thread which are kept across calls, so that the routines called over and over
+//  (the division in a loop, for instance) don't allocate for every step.
+struct ScratchWorkspace
 {
-	if(this->numLen == 0)
-	{
-		return addi;
-	}
-	else if(addi.numLen == 0)
+	limb_t* space;
+	int capacity;
+	int used;
+	
+	// The most which has been asked for at once. The space grows to it when it's not in use.
+	int wanted;
+	
+	~ScratchWorkspace()
 	{
-		return *this;
+		delete [] space;
 	}
+};
+
+// The workspace keeps no more limbs than this, and longer scratch space is allocated on each use.
+#ifndef SCRATCH_KEPT_LIMIT
+#define SCRATCH_KEPT_LIMIT (1 << 16)
+#endif
+
+static thread_local ScratchWorkspace scratchWorkspace;
+
+// Scratch space of some limbs (NOT zeroed) taken from the workspace of the thread for as long as it's in
+//  scope. It's taken from the installed allocator instead if the workspace has no room left, which
+//  happens only until the workspace has grown. The space must be released in the reverse order it's
+//  taken, which the scopes ensure.
+class ScratchLimbs
+{
+	private:
+		limb_t* space;
+		int len;
+		BigIntAllocator* allocator;
+		bool owned;
+		
+		ScratchLimbs(const ScratchLimbs&);
+		ScratchLimbs& operator=(const ScratchLimbs&);
 	
-	int newBLen;
-	if(this->isNegative ^ addi.isNegative)
-	{
-		if(this->absGreater(addi))
+	public:
+		ScratchLimbs(int _len) : allocator(nullptr)
 		{
-			unsigned char* cRet = byteWiseNegation(this->number, this->numLen, addi.number, addi.numLen, newBLen);
+			ScratchWorkspace& workspace = scratchWorkspace;
+			this->len = _len;
+			if(workspace.used + _len > workspace.wanted)
+			{
+				workspace.wanted = workspace.used + _len;
+			}
 			
-			// this->isNegative is true ==> (---) + (+) === (-), else (+++) + (-) === (+).
-			return BigInt(cRet, this->isNegative, newBLen, nullptr);
+			// The workspace is moved only while nothing is using it.
+			if(workspace.used == 0 && workspace.capacity < workspace.wanted && workspace.wanted <= SCRATCH_KEPT_LIMIT)
+			{
+				delete [] workspace.space;
+				workspace.space = new limb_t[workspace.wanted];
+				workspace.capacity = workspace.wanted;
+			}
+			
+			this->owned = (workspace.used + _len > workspace.capacity);
+			if(this->owned)
+			{
+				this->allocator = BigIntAllocator::installed();
+				this->space = (this->allocator != nullptr) ? this->allocator->allocate(_len) : new limb_t[_len];
+			}
+			else
+			{
+				this->space = workspace.space + workspace.used;
+				workspace.used += _len;
+			}
 		}
-		else
+		
+		~ScratchLimbs()
 		{
-			unsigned char* cRet = byteWiseNegation(addi.number, addi.numLen, this->number, this->numLen, newBLen);
-			
-			// this->isNegative is true ==> addi is positive ==> (-) + (+++) === (+), else (+) + (---) === (-).
-			return BigInt(cRet, addi.isNegative, newBLen, nullptr);
+			if(!this->owned)
+			{
+				scratchWorkspace.used -= this->len;
+			}
+			else if(this->allocator != nullptr)
+			{
+				this->allocator->release(this->space, this->len);
+			}
+			else
+			{
+				delete [] this->space;
+			}
 		}
-	}
-	else
-	{
-		unsigned char* cRet = byteWiseAddition(this->number, this->numLen, addi.number, addi.numLen, newBLen);
-		return BigInt(cRet, this->isNegative, newBLen, nullptr);
-	}
+		
+		operator limb_t*() const
+		{
+			return this->space;
+		}
+};
+
+BigInt::BigInt()
+{
+	this->allocLimbs(0);
+	this->numLen = 0;
+	this->isNegative = false;
+	this->digitCache = nullptr;
+	this->digitCacheLen = 0;
 }
 
-const BigInt BigInt::operator-(const BigInt& nega) const
+BigInt::BigInt(const int _limbLen, void* dummy)
 {
-	if(this->numLen == 0)
-	{
-		BigInt ret = BigInt(nega);
-		ret.isNegative = !(ret.isNegative);
-		return ret;
-	}
-	else if(nega.numLen == 0)
+	this->allocLimbs(_limbLen);
+	this->numLen = 0;
+	this->isNegative = false;
+	this->digitCache = nullptr;
+	this->digitCacheLen = 0;
+}
+
+// "void* copy" is just a dummy indicating this constructor is called.
+BigInt::BigInt(limb_t* _num, bool _isNeg, int _len, void* copy = nullptr)
+{
+	this->limbLen = this->numLen = _len;
+	for(int i = _len - 1 ; i >= 0 ; i--)
 	{
-		return *this;
+		if(_num[i] != 0)
+		{
+			break;
+		}
+		this->numLen--;
 	}
-	
-	int newBLen;
-	if(this->isNegative ^ nega.isNegative)
+	if(_num != nullptr)
 	{
-		unsigned char* cRet = byteWiseAddition(this->number, this->numLen, nega.number, nega.numLen, newBLen);
-		
-		// this->isNegative is true ==> (-) - (+) === (-), else (+) - (-) === (+).
-		return BigInt(cRet, this->isNegative, newBLen, nullptr);
+		this->number = _num;
 	}
 	else
 	{
-		if(this->absGreater(nega))
-		{
-			unsigned char* cRet = byteWiseNegation(this->number, this->numLen, nega.number, nega.numLen, newBLen);
-			
-			// this->isNegative is true ==> (---) - (-) === (-), else (+++) - (+) === (+).
-			return BigInt(cRet, this->isNegative, newBLen, nullptr);
-		}
-		else
-		{
-			unsigned char* cRet = byteWiseNegation(nega.number, nega.numLen, this->number, this->numLen, newBLen);
-			
-			// this->isNegative is true ==> (-) - (---) === (+), else (+) - (+++) === (-).
-			return BigInt(cRet, !(this->isNegative), newBLen, nullptr);
-		}
+		this->allocLimbs(0);
 	}
+	
+	// There is no negative zero.
+	this->isNegative = _isNeg && (this->numLen > 0);
+	this->digitCache = nullptr;
+	this->digitCacheLen = 0;
 }
 
-unsigned char* BigInt::multiplicationUtil(const unsigned char* cand1, int len1, const unsigned char* cand2, int len2, int& newBLen)
+BigInt::BigInt(const char* _num, bool _isNeg, int _len)
 {
-	int newLen = len1 + len2;
-	unsigned char* retVal = allocZerosMem(newLen + 1);
-	
-	unsigned char* cacheVal = allocZerosMem(newLen);
-	
-	unsigned short cache = 0;
-	unsigned char *cPtr = castPtr<unsigned char>(&cache);
-	unsigned short space = 0;
-	for(int i = 0 ; i < len1 ; i++)
+	for(int i = _len - 1 ; i >= 0 ; i--)
 	{
-		cache = 0;
-		for(int j = 0 ; j < len2 ; j++)
+		if(_num[i] != 0)
 		{
-			space = cand1[i];
-			cache += space * cand2[j];
-			cacheVal[i + j] = *cPtr;
-			cache >>= 8;
+			break;
 		}
-		cacheVal[i + len2] = *cPtr;
-		
-		byteWiseAdditionNoCopy(cacheVal, newLen, retVal, newLen, retVal, newLen + 1);
-		
-		memset(cacheVal + i, 0, len2 + 1);
+		_len--;
 	}
-	delete [] cacheVal;
+	this->numLen = (_len + sizeof(limb_t) - 1) / sizeof(limb_t);
+	this->allocLimbs(this->numLen);
 	
-	newBLen = newLen + 1;
-	return retVal;
+	// Just like "strcpy()", but copies whatever inside the specified length, including zeros.
+	//  The bytes land in little-endian order inside the limbs.
+	memcpy(this->number, _num, _len);
+	this->isNegative = _isNeg && (this->numLen > 0);
+	this->digitCache = nullptr;
+	this->digitCacheLen = 0;
 }
 
-const BigInt BigInt::operator*(const BigInt& mult) const
+BigInt::BigInt(const BigInt& copyFrom)
 {
-	// One of them is zero, than the product is zero.
-	if(this->numLen == 0 || mult.numLen == 0)
-	{
-		return BigInt(); // ZERO
-	}
-	
-	int newBLen;
-	unsigned char* retVal = multiplicationUtil(this->number, this->numLen, mult.number, mult.numLen, newBLen);
-	
-	return BigInt(retVal, this->isNegative ^ mult.isNegative, newBLen, nullptr);
+	this->allocLimbs(copyFrom.numLen);
+	this->numLen = copyFrom.numLen;
+	memcpy(this->number, copyFrom.number, this->numLen * sizeof(limb_t));
+	this->isNegative = copyFrom.isNegative;
+	this->digitCache = nullptr;
+	this->digitCacheLen = 0;
 }
 
-// The "remain" input is the number to be divided.
-void BigInt::divisionUtil(const unsigned char* divi, int diviLen, unsigned char* quotient, int qLen, unsigned char* remain)
+BigInt::BigInt(BigInt&& moveFrom)
 {
-	int dividersCacheLen[8];
-	unsigned char* dividersCache[8];
+	this->takeLimbs(moveFrom);
+	this->digitCache = moveFrom.digitCache;
+	this->digitCacheLen = moveFrom.digitCacheLen;
 	
-	// Creates the 8 shifted caches of the divisor.
-	for(int i = 0 ; i < 8 ; i++)
-	{
-		dividersCache[i] = shiftBits(i, divi, diviLen, dividersCacheLen[i]);
+	moveFrom.digitCache = nullptr;
+	moveFrom.digitCacheLen = 0;
+}
 
-		/*
-		if(dividersCache[i][dividersCacheLen[i] - 1] == 0)
-		{
-			dividersCacheLen[i]--;
-		}
-		*/
+BigInt::~BigInt()
+{
+	this->releaseLimbs();
+	delete [] this->digitCache;
+}
+
+void BigInt::allocLimbs(int _len)
+{
+	if(_len <= BIGINT_INLINE_LIMBS)
+	{
+		this->limbLen = BIGINT_INLINE_LIMBS;
+		this->number = this->inlineLimbs;
+		memset(this->inlineLimbs, 0, sizeof(this->inlineLimbs));
 	}
-	
-	// The division is implemented in binary format. Each byte contains 8 bits, or 8 binary 'digits'.
-	//  In binary division, the divisor is left shifted to be aligned with the head of the current
-	//  remain, and checked if the value is less than the leading bytes of the remain.
-	//  If true, then the remain is substracted by the shifted divisor, and the corresponding bit of
-	//  the quotient is added.
-	for(int i = qLen - 1 ; i >= 0 ; i--)
+	else
 	{
-		for(int j = 7 ; j >= 0 ; j--)
-		{
-			if(byteWiseGreater(remain + i, dividersCache[j], dividersCacheLen[j], true))
-			{
-				quotient[i] += (1 << j);
-				byteWiseNegationNoCopy(remain + i, dividersCacheLen[j], dividersCache[j], dividersCacheLen[j], remain + i, dividersCacheLen[j]);
-			}
-		}
-	}
-	
-	for(int i = 0 ; i < 8 ; i++)
-	{
-		delete [] dividersCache[i];
+		this->limbLen = _len;
+		this->number = allocZerosMem(_len);
 	}
 }
 
-unsigned char* BigInt::divisionUtil(const BigInt& divi, int& bOutLen, bool q_than_r) const // true -> q ; false -> r
+void BigInt::releaseLimbs()
 {
-	if(divi.absGreater(*this))
+	if(this->number != this->inlineLimbs)
 	{
-		if(q_than_r)
-		{
-			bOutLen = 0;
-			return nullptr;
-		}
-		else
-		{
-			bOutLen = this->numLen;
-			unsigned char* copy = new unsigned char[this->numLen];
-			memcpy(copy, this->number, this->numLen);
-			return copy;
-		}
+		freeLimbArray(this->number);
 	}
-	else if(divi.numLen == 0) // Divided by zero.
+}
+
+void BigInt::growLimbs(int _len)
+{
+	if(this->limbLen >= _len)
 	{
-		char* error = nullptr;
-		*error = 0; // Crash the program on purpose. Get rekt for dividing sth by zero. lol.
+		return;
 	}
 	
-	unsigned char* cache = new unsigned char[this->numLen + 1];
-	cache[this->numLen] = 0;
-	memcpy(cache, this->number, this->numLen);
-	
-	int qLen = this->numLen - divi.numLen + 1;
-	unsigned char* quotient = allocZerosMem(qLen);
-	
-	divisionUtil(divi.number, divi.numLen, quotient, qLen, cache);
-	
-	if(q_than_r)
+	limb_t* grown = allocZerosMem(_len);
+	memcpy(grown, this->number, this->numLen * sizeof(limb_t));
+	this->releaseLimbs();
+	this->number = grown;
+	this->limbLen = _len;
+}
+
+void BigInt::reserve(int byteLength)
+{
+	this->growLimbs((byteLength + sizeof(limb_t) - 1) / sizeof(limb_t));
+}
+
+void BigInt::takeLimbs(BigInt& moveFrom)
+{
+	if(moveFrom.number == moveFrom.inlineLimbs)
 	{
-		delete [] cache;
-		bOutLen = qLen;
-		return quotient;
+		this->limbLen = BIGINT_INLINE_LIMBS;
+		this->number = this->inlineLimbs;
+		memcpy(this->inlineLimbs, moveFrom.inlineLimbs, sizeof(this->inlineLimbs));
+		memset(moveFrom.inlineLimbs, 0, sizeof(moveFrom.inlineLimbs));
 	}
 	else
 	{
-		delete [] quotient;
-		bOutLen = this->numLen + 1;
-		return cache;
+		this->limbLen = moveFrom.limbLen;
+		this->number = moveFrom.number;
+		moveFrom.limbLen = BIGINT_INLINE_LIMBS;
+		moveFrom.number = moveFrom.inlineLimbs;
 	}
+	this->numLen = moveFrom.numLen;
+	this->isNegative = moveFrom.isNegative;
+	
+	moveFrom.numLen = 0;
+	moveFrom.isNegative = false;
 }
 
-const BigInt BigInt::operator/(const BigInt& divi) const
+void BigInt::clearDigitCache()
 {
-	int bOutLen;
-	unsigned char* retVal = this->divisionUtil(divi, bOutLen, true);
-	return BigInt(retVal, this->isNegative ^ divi.isNegative, bOutLen, nullptr);
+	delete [] this->digitCache;
+	this->digitCache = nullptr;
+	this->digitCacheLen = 0;
 }
 
-const BigInt BigInt::operator%(const BigInt& divi) const
+int BigInt::getByteLength() const
 {
-	int bOutLen;
-	unsigned char* retVal = this->divisionUtil(divi, bOutLen, false);
-	return BigInt(retVal, this->isNegative, bOutLen, nullptr);
+	return this->limbLen * sizeof(limb_t);
 }
 
-const BigInt& BigInt::operator+=(const BigInt& addi)
+// This WILL NOT copy the input data!
+void BigInt::setValues(limb_t* newNumber, int newLimbLen, bool newNegative)
 {
-	if(this->numLen == 0)
+	this->clearDigitCache();
+	this->releaseLimbs();
+	if(newNumber != nullptr)
 	{
-		this->numLen = this->byteLen = addi.numLen;
-		delete [] this->number;
-		this->number = new unsigned char[addi.numLen];
-		memcpy(this->number, addi.number, this->byteLen);
-		this->isNegative = addi.isNegative;
-		return *this;
+		this->number = newNumber;
+		this->limbLen = newLimbLen;
 	}
-	else if(addi.numLen == 0)
+	else
 	{
-		return *this;
+		this->allocLimbs(0);
 	}
+	this->isNegative = newNegative;
 	
-	int newBLen;
-	if(this->isNegative ^ addi.isNegative)
+	for(int i = (this->limbLen - 1) ; i >= 0 ; i--)
 	{
-		if(this->absGreater(addi))
-		{
-			unsigned char* cRet = byteWiseNegation(this->number, this->numLen, addi.number, addi.numLen, newBLen);
-			
-			// this->isNegative is true ==> (---) + (+) === (-), else (+++) + (-) === (+).
-			this->setValues(cRet, newBLen, this->isNegative);
-			
-			return *this;
-		}
-		else
+		if(this->number[i] != 0)
 		{
-			unsigned char* cRet = byteWiseNegation(addi.number, addi.numLen, this->number, this->numLen, newBLen);
-			
-			// this->isNegative is true ==> addi is positive ==> (-) + (+++) === (+), else (+) + (---) === (-).
-			this->setValues(cRet, newBLen, addi.isNegative);
-			
-			return *this;
+			this->numLen = i + 1;
+			return;
 		}
 	}
-	else
-	{
-		unsigned char* cRet = byteWiseAddition(this->number, this->numLen, addi.number, addi.numLen, newBLen);
-		
-		this->setValues(cRet, newBLen, this->isNegative);
-		
-		return *this;
-	}
+	this->numLen = 0;
+	this->isNegative = false;
 }
 
-const BigInt& BigInt::operator-=(const BigInt& nega)
+void BigInt::additionInPlace(const limb_t* num, int len, bool neg)
 {
-	if(this->numLen == 0)
-	{
-		this->numLen = this->byteLen = nega.numLen;
-		delete [] this->number;
-		this->number = new unsigned char[nega.numLen];
-		memcpy(this->number, nega.number, this->byteLen);
-		this->isNegative = !(nega.isNegative);
-		return *this;
-	}
-	else if(nega.numLen == 0)
+	this->clearDigitCache();
+	
+	if(len == 0)
 	{
-		return *this;
+		return;
 	}
 	
-	int newBLen;
-	if(this->isNegative ^ nega.isNegative)
+	// The result takes one more limb than the longer one if it's a summation, and no more than the longer
+	//  one otherwise.
+	bool summation = (this->isNegative == neg || this->numLen == 0);
+	int longer = (this->numLen > len) ? this->numLen : len;
+	int needed = summation ? (longer + 1) : longer;
+	if(this->limbLen < needed)
 	{
-		unsigned char* cRet = byteWiseAddition(this->number, this->numLen, nega.number, nega.numLen, newBLen);
-		
-		// this->isNegative is true ==> (-) - (+) === (-), else (+) - (-) === (+).
-		this->setValues(cRet, newBLen, this->isNegative);
-		
-		return *this;
+		bool self = (num == this->number);
+		this->growLimbs(grownCapacity(this->limbLen, needed));
+		if(self)
+		{
+			num = this->number;
+		}
 	}
-	else
+	
+	if(summation)
 	{
-		if(this->absGreater(nega))
+		if(this->numLen >= len)
 		{
-			unsigned char* cRet = byteWiseNegation(this->number, this->numLen, nega.number, nega.numLen, newBLen);
-			
-			// this->isNegative is true ==> (---) - (-) === (-), else (+++) - (+) === (+).
-			this->setValues(cRet, newBLen, this->isNegative);
-			
-			return *this;
+			limbWiseAdditionNoCopy(this->number, this->numLen, num, len, this->number, longer + 1);
 		}
 		else
 		{
-			unsigned char* cRet = byteWiseNegation(nega.number, nega.numLen, this->number, this->numLen, newBLen);
-			
-			// this->isNegative is true ==> (-) - (---) === (+), else (+) - (+++) === (-).
-			this->setValues(cRet, newBLen, !(this->isNegative));
-			
-			return *this;
+			limbWiseAdditionNoCopy(num, len, this->number, this->numLen, this->number, longer + 1);
 		}
+		this->numLen = longer + (this->number[longer] != 0);
+		this->isNegative = neg;
+		return;
+	}
+	
+	if(limbWiseCompare(this->number, this->numLen, num, len) >= 0)
+	{
+		// (---) + (+) === (-), and (+++) + (-) === (+).
+		limbWiseNegationNoCopy(this->number, this->numLen, num, len, this->number, this->numLen);
+		this->numLen = trimmedLen(this->number, this->numLen);
+		this->isNegative = this->isNegative && (this->numLen > 0);
+		return;
 	}
+	
+	// (-) + (+++) === (+), and (+) + (---) === (-).
+	limbWiseNegationNoCopy(num, len, this->number, this->numLen, this->number, len);
+	this->numLen = trimmedLen(this->number, len);
+	this->isNegative = neg;
 }
 
-const BigInt& BigInt::operator*=(const BigInt& mult)
+void BigInt::multiplyAddInPlace(const BigInt& mult1, const BigInt& mult2, bool negate)
 {
-	if(this->numLen == 0)
+	if(mult1.numLen == 0 || mult2.numLen == 0)
 	{
-		return *this; // ZERO
+		return;
 	}
-	else if(mult.numLen == 0)
+	
+	bool neg = mult1.isNegative ^ mult2.isNegative ^ negate;
+	if(mult2.numLen == 1)
 	{
-		this->byteLen = this->numLen = 0;
-		delete [] this->number;
-		this->number = nullptr;
-		return *this;
+		this->limbMultiplyAddInPlace(mult1.number, mult1.numLen, mult2.number[0], neg);
+		return;
+	}
+	if(mult1.numLen == 1)
+	{
+		this->limbMultiplyAddInPlace(mult2.number, mult2.numLen, mult1.number[0], neg);
+		return;
 	}
 	
-	int newBLen;
-	unsigned char* retVal = multiplicationUtil(this->number, this->numLen, mult.number, mult.numLen, newBLen);
-	this->setValues(retVal, newBLen, this->isNegative ^ mult.isNegative);
-	return *this;
+	// The product lives in the scratch space only until it's added, so the factors MAY be this BigInt.
+	int len = mult1.numLen + mult2.numLen;
+	ScratchLimbs product(len);
+	multiplicationNoCopy(mult1.number, mult1.numLen, mult2.number, mult2.numLen, product);
+	this->additionInPlace(product, trimmedLen(product, len), neg);
 }
 
-const BigInt& BigInt::operator/=(const BigInt& divi)
+void BigInt::limbMultiplyAddInPlace(const limb_t* num, int len, limb_t mult, bool neg)
 {
-	int bOutLen;
-	unsigned char* retVal = this->divisionUtil(divi, bOutLen, true);
-	this->setValues(retVal, bOutLen, this->isNegative ^ divi.isNegative);
-	return *this;
+	this->clearDigitCache();
+	
+	if(len == 0 || mult == 0)
+	{
+		return;
+	}
+	
+	// The product takes at most one more limb than <num>, and the sum one more than the longer one.
+	int longer = (this->numLen > len + 1) ? this->numLen : (len + 1);
+	if(this->limbLen < longer + 1)
+	{
+		bool self = (num == this->number);
+		this->growLimbs(grownCapacity(this->limbLen, longer + 1));
+		if(self)
+		{
+			num = this->number;
+		}
+	}
+	
+	if(this->isNegative == neg || this->numLen == 0)
+	{
+		limb_t carry = limbMultiplyAddNoCopy(num, len, mult, this->number);
+		limbWiseAdditionNoCopy(this->number + len, longer + 1 - len, &carry, 1, this->number + len, longer + 1 - len);
+		this->numLen = trimmedLen(this->number, longer + 1);
+		this->isNegative = neg;
+		return;
+	}
+	
+	// The difference is taken in two's complement, and a borrow out of the top means that the product is
+	//  the greater one, so the difference is negated back.
+	limb_t borrow = limbMultiplySubtractNoCopy(num, len, mult, this->number);
+	if(limbWiseNegationNoCopy(this->number + len, longer - len, &borrow, 1, this->number + len, longer - len) != 0)
+	{
+		limb_t carry = 1;
+		for(int i = 0 ; i < longer ; i++)
+		{
+			this->number[i] = ~this->number[i] + carry;
+			carry = (this->number[i] < carry);
+		}
+		this->isNegative = neg;
+	}
+	this->numLen = trimmedLen(this->number, longer);
+	this->isNegative = this->isNegative && (this->numLen > 0);
 }
 
-const BigInt& BigInt::operator%=(const BigInt& divi)
+void BigInt::setZero()
 {
-	int bOutLen;
-	unsigned char* retVal = this->divisionUtil(divi, bOutLen, false);
-	this->setValues(retVal, bOutLen, this->isNegative);
-	return *this;
+	this->clearDigitCache();
+	memset(this->number, 0, this->numLen * sizeof(limb_t));
+	this->numLen = 0;
+	this->isNegative = false;
 }
 
-const BigInt& BigInt::operator++()
+limb_t BigInt::limbWiseAdditionNoCopy(const limb_t* cand1, int len1, const limb_t* cand2, int len2, limb_t* ret, int lenOut)
 {
-	static const unsigned char *ONE = new unsigned char(1);
+	limb_t carry = 0;
+	limb_t sum;
 	
-	if(this->numLen == 0) // zero
+	int i;
+	for(i = 0 ; i < len2 ; i++)
 	{
-		this->byteLen = this->numLen = 1;
-		delete [] this->number;
-		this->number = new unsigned char[1];
-		this->number[0] = 1;
-		this->isNegative = false;
+		sum = cand1[i] + carry;
+		carry = (sum < carry);
+		sum += cand2[i];
+		carry += (sum < cand2[i]);
+		ret[i] = sum;
 	}
-	else
+	
+	for(i = len2 ; i < len1 ; i++)
 	{
-		if(this->isNegative)
-		{
-			byteWiseNegationNoCopy(this->number, this->numLen, ONE, 1, this->number, this->numLen);
-		
-			// When negating only by 1, we'd check if the leading byte is zero after the operation.
-			//  If it's zero, it means that the carry went all the way from the 0th order to the leading byte,
-			//  and "removed" that byte. Just like "010000 - 1 = 00FFFF".
-			if(this->number[this->numLen - 1] == 0)
-			{
-				this->numLen--;
-			}
-		}
-		else
-		{
-			byteWiseAdditionNoCopy(this->number, this->numLen, ONE, 1, this->number, this->numLen);
-		
-			// When adding only by 1, we'd check if the leading byte is zero after the operation.
-			//  If it's zero, it means that the carry went all the way from the 0th order to the leading byte,
-			//  and "overflow"ed that byte. Just like "FFFF + 1 = (01)0000". The "(01)" is the overflow.
-			if(this->number[this->numLen - 1] == 0)
-			{
-				// Extra space available
-				//  -> Do not create a new memory chunk and do crazy stuffs.
-				if(this->byteLen > this->numLen)
-				{
-					this->number[this->numLen] = 1;
-					this->numLen++;
-				}
-				else
-				{
-					unsigned char *old = this->number;
-					this->byteLen = ++(this->numLen); // ++nl, NOT nl++ !!!!!
-					this->number = new unsigned char[this->byteLen];
-					memcpy(this->number, old, this->numLen - 1); // copy all the zeros. :>
-					this->number[this->numLen - 1] = 1;
-				}
-			}
-		}
+		sum = cand1[i] + carry;
+		// The carry of this partial addition should be added into the next limb.
+		carry = (sum < carry);
+		ret[i] = sum;
 	}
-	return *this;
+	
+	if(lenOut > len1)
+	{
+		ret[len1] = carry;
+	}
+	return carry;
 }
 
-const BigInt& BigInt::operator--()
+limb_t* BigInt::limbWiseAddition(const limb_t* cand1, int len1, const limb_t* cand2, int len2, int& lenOut)
 {
-	static const unsigned char *ONE = new unsigned char(1);
-	
-	if(this->numLen == 0) // zero
+	bool lenComp = (len1 > len2);
+	lenOut = (lenComp ? len1 : len2) + 1;
+	limb_t *ret = allocLimbArray(lenOut);
+	if(lenComp)
 	{
-		this->byteLen = this->numLen = 1;
-		delete [] this->number;
-		this->number = new unsigned char[1];
-		this->number[0] = 1;
-		this->isNegative = true; // Set to -1;
+		limbWiseAdditionNoCopy(cand1, len1, cand2, len2, ret, lenOut);
 	}
 	else
 	{
-		if(this->isNegative)
-		{
-			byteWiseAdditionNoCopy(this->number, this->numLen, ONE, 1, this->number, this->numLen);
-			if(this->number[this->numLen - 1] == 0)
-			{
-				// Extra space available
-				//  -> Do not create a new memory chunk and do crazy stuffs.
-				if(this->byteLen > this->numLen)
-				{
-					this->number[this->numLen] = 1;
-					this->numLen++;
-				}
-				else
-				{
-					unsigned char *old = this->number;
-					this->byteLen = ++(this->numLen); // ++nl, NOT nl++ !!!!!
-					this->number = new unsigned char[this->numLen];
-					memcpy(this->number, old, this->numLen - 1);
-					this->number[this->numLen - 1] = 1;
-				}
-			}
-		}
-		else
-		{
-			byteWiseNegationNoCopy(this->number, this->numLen, ONE, 1, this->number, this->numLen);
-			if(this->number[this->numLen - 1] == 0)
-			{
-				this->numLen--;
-			}
-		}
+		limbWiseAdditionNoCopy(cand2, len2, cand1, len1, ret, lenOut);
 	}
-	return *this;
+	return ret;
 }
 
-void BigInt::operator++(int)
+limb_t BigInt::limbWiseNegationNoCopy(const limb_t* cand1, int len1, const limb_t* cand2, int len2, limb_t* ret, int lenOut)
 {
-	++(*this);
+	limb_t borrow = 0;
+	limb_t diff;
+	
+	int i;
+	// The input is made sure that cand1 > cand2 is always true.
+	for(i = 0 ; i < len2 ; i++)
+	{
+		diff = cand1[i] - cand2[i];
+		limb_t nextBorrow = (cand1[i] < cand2[i]);
+		nextBorrow |= (diff < borrow);
+		ret[i] = diff - borrow;
+		
+		// The "extra 1" that has to be negated in the next limb.
+		borrow = nextBorrow;
+	}
+	
+	for(i = len2 ; i < len1 ; i++)
+	{
+		diff = cand1[i] - borrow;
+		borrow = (cand1[i] < borrow);
+		ret[i] = diff;
+	}
+	return borrow;
 }
 
-void BigInt::operator--(int)
+limb_t* BigInt::limbWiseNegation(const limb_t* cand1, int len1, const limb_t* cand2, int len2, int& lenOut)
 {
-	--(*this);
+	lenOut = len1;
+	limb_t *ret = allocLimbArray(lenOut);
+	limbWiseNegationNoCopy(cand1, len1, cand2, len2, ret, lenOut);
+	
+	return ret;
 }
 
-bool BigInt::operator==(const BigInt& comp) const
+bool BigInt::limbWiseGreater(const limb_t* cand1, const limb_t* cand2, int len, bool equal = false)
 {
-	if(this->numLen == comp.numLen && this->isNegative == comp.isNegative)
+	for(int i = len - 1 ; i >= 0 ; i--)
 	{
-		if(this->numLen == 0)
+		if(cand1[i] > cand2[i])
 		{
 			return true;
 		}
-		for(int i = 0 ; i < this->numLen ; i++)
+		else if(cand1[i] < cand2[i])
 		{
-			if(this->number[i] != comp.number[i])
-			{
-				return false;
-			}
+			return false;
 		}
-		return true;
 	}
-	return false;
+	
+	// Equal.
+	return equal;
 }
 
-bool BigInt::operator!=(const BigInt& comp) const
+bool BigInt::absGreater(const BigInt& comp) const
 {
-	return !(*this == comp);
+	if(this->numLen == comp.numLen)
+	{
+		return limbWiseGreater(this->number, comp.number, this->numLen);
+	}
+	else
+	{
+		return (this->numLen > comp.numLen);
+	}
 }
 
-bool BigInt::operator>=(const BigInt& comp) const
+limb_t* BigInt::shiftBits(int offset, const limb_t* cand1, int len1, int& lenOut)
 {
-	if(this->isNegative ^ comp.isNegative)
+	limb_t *ret = nullptr;
+	if(offset > 0)
 	{
-		// comp.isNegative == true --> "this" is positive.
-		return comp.isNegative;
+		int offLimbs = offset / LIMB_BITS;
+		int offBits = offset % LIMB_BITS;
+		int offBitsCompliment = LIMB_BITS - offBits;
+		lenOut = len1 + offLimbs + 1;
+	
+		ret = allocZerosMem(lenOut);
+		if(offBits == 0)
+		{
+			memcpy(ret + offLimbs, cand1, len1 * sizeof(limb_t));
+			return ret;
+		}
+		for(int i = 0 ; i < len1 ; i++)
+		{
+			ret[i + offLimbs] |= cand1[i] << offBits;
+			ret[i + offLimbs + 1] = cand1[i] >> offBitsCompliment; // The "head" of the limb after that is "carried" to this limb.
+		}
 	}
-	else if(this->numLen != comp.numLen)
+	else if(offset < 0)
 	{
-		// Both negative -> if "this" is "shorter". Otherwise, reverse.
-		return (this->isNegative ^ (this->numLen > comp.numLen));
+		offset = -offset;
+		int offLimbs = offset / LIMB_BITS;
+		int offBits = offset % LIMB_BITS;
+		int offBitsCompliment = LIMB_BITS - offBits;
+		if(offLimbs >= len1)
+		{
+			lenOut = 0;
+			return nullptr;
+		}
+		lenOut = len1 - offLimbs;
+		ret = allocLimbArray(lenOut);
+		if(offBits == 0)
+		{
+			memcpy(ret, cand1 + offLimbs, lenOut * sizeof(limb_t));
+			return ret;
+		}
+		for(int i = offLimbs ; i < len1 - 1 ; i++)
+		{
+			ret[i - offLimbs] = (cand1[i] >> offBits) | (cand1[i + 1] << offBitsCompliment);
+		}
+		ret[len1 - offLimbs - 1] = (cand1[len1 - 1] >> offBits);
 	}
-	else
+	else // offset == 0 is only used in division processing.
 	{
-		return byteWiseGreater(this->number, comp.number, this->numLen, true);
+		lenOut = len1 + 1;
+		ret = allocLimbArray(lenOut);
+		ret[len1] = 0;
+		memcpy(ret, cand1, len1 * sizeof(limb_t));
 	}
+	return ret;
 }
 
-bool BigInt::operator<=(const BigInt& comp) const
+limb_t* BigInt::allocZerosMem(int _len)
 {
-	return (comp >= *this);
+	limb_t* ret = allocLimbArray(_len);
+	memset(ret, 0, _len * sizeof(limb_t));
+	return ret;
 }
 
-bool BigInt::operator>(const BigInt& comp) const
+limb_t* BigInt::allocLimbArray(int _len)
 {
-	if(this->isNegative ^ comp.isNegative)
+	BigIntAllocator* allocator = installedAllocator;
+	int total = _len + LIMB_ARRAY_HEADER;
+	limb_t* space = (allocator != nullptr) ? allocator->allocate(total) : new limb_t[total];
+	*reinterpret_cast<BigIntAllocator**>(space) = allocator;
+	space[1] = total;
+	return space + LIMB_ARRAY_HEADER;
+}
+
+void BigInt::freeLimbArray(limb_t* num)
+{
+	if(num == nullptr)
 	{
-		// comp.isNegative == true --> "this" is positive.
-		return comp.isNegative;
+		return;
 	}
-	else if(this->numLen != comp.numLen)
+	
+	limb_t* space = num - LIMB_ARRAY_HEADER;
+	BigIntAllocator* allocator = *reinterpret_cast<BigIntAllocator**>(space);
+	if(allocator != nullptr)
 	{
-		// Both positive -> if "this" is longer. Otherwise, reverse.
-		return (this->isNegative ^ (this->numLen > comp.numLen));
+		allocator->release(space, (int)space[1]);
 	}
 	else
 	{
-		return byteWiseGreater(this->number, comp.number, this->numLen, false);
+		delete [] space;
 	}
 }
 
-bool BigInt::operator<(const BigInt& comp) const
-{
-	return (comp > *this);
-}
-
-const BigInt BigInt::operator<<(const int offset) const
+const BigInt& BigInt::operator=(const BigInt& copyFrom)
+{
+	if(this == &copyFrom)
+	{
+		return *this;
+	}
+	this->clearDigitCache();
+	
+	// The current space is reused if it's large enough. Only the part beyond the new value that was
+	//  used by the old one has to be cleared.
+	if(this->limbLen >= copyFrom.numLen)
+	{
+		if(this->numLen > copyFrom.numLen)
+		{
+			memset(this->number + copyFrom.numLen, 0, (this->numLen - copyFrom.numLen) * sizeof(limb_t));
+		}
+	}
+	else
+	{
+		this->releaseLimbs();
+		this->allocLimbs(copyFrom.numLen);
+	}
+	
+	memcpy(this->number, copyFrom.number, copyFrom.numLen * sizeof(limb_t));
+	this->numLen = copyFrom.numLen;
+	this->isNegative = copyFrom.isNegative;
+	
+	return *this;
+}
+
+const BigInt& BigInt::operator=(BigInt&& moveFrom)
+{
+	if(this == &moveFrom)
+	{
+		return *this;
+	}
+	
+	this->releaseLimbs();
+	delete [] this->digitCache;
+	
+	this->takeLimbs(moveFrom);
+	this->digitCache = moveFrom.digitCache;
+	this->digitCacheLen = moveFrom.digitCacheLen;
+	
+	moveFrom.digitCache = nullptr;
+	moveFrom.digitCacheLen = 0;
+	
+	return *this;
+}
+
+BigInt BigInt::operator-() const &
+{
+	BigInt ret(*this);
+	ret.isNegative = !(this->isNegative) && (this->numLen > 0);
+	return ret;
+}
+
+BigInt BigInt::operator-() &&
+{
+	this->clearDigitCache();
+	this->isNegative = !(this->isNegative) && (this->numLen > 0);
+	return static_cast<BigInt&&>(*this);
+}
+
+BigInt BigInt::abs() const
+{
+	BigInt ret(*this);
+	ret.isNegative = false;
+	return ret;
+}
+
+BigInt BigInt::operator+(const BigInt& addi) const &
+{
+	// Room for the carry is made beforehand, so the sum never needs another limb array.
+	int longer = (this->numLen > addi.numLen) ? this->numLen : addi.numLen;
+	BigInt ret(longer + 1, nullptr);
+	memcpy(ret.number, this->number, this->numLen * sizeof(limb_t));
+	ret.numLen = this->numLen;
+	ret.isNegative = this->isNegative;
+	ret.additionInPlace(addi.number, addi.numLen, addi.isNegative);
+	return ret;
+}
+
+BigInt BigInt::operator-(const BigInt& nega) const &
+{
+	int longer = (this->numLen > nega.numLen) ? this->numLen : nega.numLen;
+	BigInt ret(longer + 1, nullptr);
+	memcpy(ret.number, this->number, this->numLen * sizeof(limb_t));
+	ret.numLen = this->numLen;
+	ret.isNegative = this->isNegative;
+	ret.additionInPlace(nega.number, nega.numLen, !(nega.isNegative));
+	return ret;
+}
+
+BigInt BigInt::operator+(const BigInt& addi) &&
+{
+	this->additionInPlace(addi.number, addi.numLen, addi.isNegative);
+	return static_cast<BigInt&&>(*this);
+}
+
+BigInt BigInt::operator+(BigInt&& addi) const &
+{
+	addi.additionInPlace(this->number, this->numLen, this->isNegative);
+	return static_cast<BigInt&&>(addi);
+}
+
+BigInt BigInt::operator+(BigInt&& addi) &&
+{
+	// The longer one probably has the room for the summation.
+	if(addi.limbLen > this->limbLen)
+	{
+		addi.additionInPlace(this->number, this->numLen, this->isNegative);
+		return static_cast<BigInt&&>(addi);
+	}
+	this->additionInPlace(addi.number, addi.numLen, addi.isNegative);
+	return static_cast<BigInt&&>(*this);
+}
+
+BigInt BigInt::operator-(const BigInt& nega) &&
+{
+	this->additionInPlace(nega.number, nega.numLen, !(nega.isNegative));
+	return static_cast<BigInt&&>(*this);
+}
+
+BigInt BigInt::operator-(BigInt&& nega) const &
+{
+	// a - b === -(b - a).
+	nega.additionInPlace(this->number, this->numLen, !(this->isNegative));
+	nega.isNegative = !(nega.isNegative) && (nega.numLen > 0);
+	return static_cast<BigInt&&>(nega);
+}
+
+BigInt BigInt::operator-(BigInt&& nega) &&
+{
+	this->additionInPlace(nega.number, nega.numLen, !(nega.isNegative));
+	return static_cast<BigInt&&>(*this);
+}
+
+limb_t BigInt::limbMultiplicationNoCopy(const limb_t* cand1, int len1, limb_t mult, limb_t* ret)
+{
+	limb_t carry = 0, lo, hi;
+	for(int i = 0 ; i < len1 ; i++)
+	{
+		lo = mulLimbs(cand1[i], mult, hi);
+		lo += carry;
+		hi += (lo < carry);
+		ret[i] = lo;
+		carry = hi;
+	}
+	return carry;
+}
+
+limb_t BigInt::limbMultiplyAddNoCopy(const limb_t* cand1, int len1, limb_t mult, limb_t* ret)
+{
+	limb_t carry = 0, lo, hi;
+	for(int i = 0 ; i < len1 ; i++)
+	{
+		lo = mulLimbs(cand1[i], mult, hi);
+		lo += carry;
+		hi += (lo < carry);
+		lo += ret[i];
+		hi += (lo < ret[i]);
+		ret[i] = lo;
+		carry = hi;
+	}
+	return carry;
+}
+
+limb_t BigInt::limbMultiplySubtractNoCopy(const limb_t* cand1, int len1, limb_t mult, limb_t* ret)
+{
+	limb_t borrow = 0, lo, hi;
+	for(int i = 0 ; i < len1 ; i++)
+	{
+		lo = mulLimbs(cand1[i], mult, hi);
+		lo += borrow;
+		hi += (lo < borrow);
+		borrow = hi + (ret[i] < lo);
+		ret[i] -= lo;
+	}
+	return borrow;
+}
+
+limb_t BigInt::limbDivisionNoCopy(const limb_t* cand1, int len1, limb_t divi, limb_t* ret)
+{
+	// The dividend is shifted along with the divisor on the fly, so that the divisor is normalized.
+	int shift = countLeadingZeros(divi);
+	divi <<= shift;
+	limb_t inv = limbReciprocal(divi);
+	
+	limb_t rem = (shift && len1 > 0) ? (cand1[len1 - 1] >> (LIMB_BITS - shift)) : 0;
+	for(int i = len1 - 1 ; i >= 0 ; i--)
+	{
+		limb_t next = (shift && i > 0) ? (cand1[i - 1] >> (LIMB_BITS - shift)) : 0;
+		limb_t q = divLimbsPreinv(rem, (cand1[i] << shift) | next, divi, inv, rem);
+		if(ret)
+		{
+			ret[i] = q;
+		}
+	}
+	return rem >> shift;
+}
+
+int BigInt::limbWiseCompare(const limb_t* cand1, int len1, const limb_t* cand2, int len2)
+{
+	while(len1 > 0 && cand1[len1 - 1] == 0)
+	{
+		len1--;
+	}
+	while(len2 > 0 && cand2[len2 - 1] == 0)
+	{
+		len2--;
+	}
+	if(len1 != len2)
+	{
+		return (len1 > len2) ? 1 : -1;
+	}
+	for(int i = len1 - 1 ; i >= 0 ; i--)
+	{
+		if(cand1[i] != cand2[i])
+		{
+			return (cand1[i] > cand2[i]) ? 1 : -1;
+		}
+	}
+	return 0;
+}
+
+void BigInt::schoolbookMultiplicationNoCopy(const limb_t* cand1, int len1, const limb_t* cand2, int len2, limb_t* ret)
+{
+	if(cand1 == cand2 && len1 == len2)
+	{
+		schoolbookSquareNoCopy(cand1, len1, ret);
+		return;
+	}
+	
+	// Each row adds <cand1> times one limb of <cand2> right into the product, so the longer candidate
+	//  should be walked by the inner loop.
+	if(len1 < len2)
+	{
+		const limb_t* swap = cand1;
+		cand1 = cand2;
+		cand2 = swap;
+		int swapLen = len1;
+		len1 = len2;
+		len2 = swapLen;
+	}
+	
+	ret[len1] = limbMultiplicationNoCopy(cand1, len1, cand2[0], ret);
+	for(int i = 1 ; i < len2 ; i++)
+	{
+		ret[len1 + i] = limbMultiplyAddNoCopy(cand1, len1, cand2[i], ret + i);
+	}
+}
+
+void BigInt::schoolbookSquareNoCopy(const limb_t* cand, int len, limb_t* ret)
+{
+	// The products a[i] * a[j] with i < j are summed up once, then doubled, and the squares a[i]^2 are
+	//  added along the diagonal. Row i lands on limbs [2 * i + 1, i + len], and nothing has been written
+	//  to the top one yet, so it simply takes the carry.
+	memset(ret, 0, 2 * len * sizeof(limb_t));
+	for(int i = 0 ; i < len - 1 ; i++)
+	{
+		ret[i + len] = limbMultiplyAddNoCopy(cand + i + 1, len - i - 1, cand[i], ret + 2 * i + 1);
+	}
+	
+	limb_t shiftIn = 0, carry = 0, lo, hi;
+	for(int i = 0 ; i < len ; i++)
+	{
+		limb_t r0 = ret[2 * i], r1 = ret[2 * i + 1];
+		limb_t d0 = (r0 << 1) | shiftIn;
+		limb_t d1 = (r1 << 1) | (r0 >> (LIMB_BITS - 1));
+		shiftIn = r1 >> (LIMB_BITS - 1);
+		
+		lo = mulLimbs(cand[i], cand[i], hi);
+		lo += carry;
+		hi += (lo < carry);
+		d0 += lo;
+		hi += (d0 < lo);
+		d1 += hi;
+		carry = (d1 < hi);
+		ret[2 * i] = d0;
+		ret[2 * i + 1] = d1;
+	}
+}
+
+// Length of the working space needed by karatsubaMultiplicationNoCopy() for <len> limbs.
+static int karatsubaScratchLen(int len)
+{
+	int total = 1;
+	while(len >= KARATSUBA_THRESHOLD)
+	{
+		len = (len + 1) / 2;
+		total += 4 * len + 1;
+	}
+	return total;
+}
+
+void BigInt::karatsubaMultiplicationNoCopy(const limb_t* cand1, const limb_t* cand2, int len, limb_t* ret, limb_t* scratch)
+{
+	if(len < KARATSUBA_THRESHOLD)
+	{
+		schoolbookMultiplicationNoCopy(cand1, len, cand2, len, ret);
+		return;
+	}
+	
+	// cand1 = a1 * B^low + a0, cand2 = b1 * B^low + b0, where B = 2^64.
+	//  The product is z2 * B^(2 * low) + z1 * B^low + z0, with
+	//  z0 = a0 * b0, z2 = a1 * b1 and z1 = z0 + z2 - (a0 - a1) * (b0 - b1).
+	//  When squaring, all three of the sub-products are squares as well.
+	bool square = (cand1 == cand2);
+	int low = (len + 1) / 2;
+	int high = len - low;
+	
+	limb_t* diff1 = scratch;
+	limb_t* diff2 = scratch + low;
+	limb_t* diffProd = scratch + 2 * low + 1;
+	limb_t* next = scratch + 4 * low + 1;
+	
+	karatsubaMultiplicationNoCopy(cand1, cand2, low, ret, next);
+	if(high == low)
+	{
+		karatsubaMultiplicationNoCopy(cand1 + low, cand2 + low, high, ret + 2 * low, next);
+	}
+	else
+	{
+		multiplicationNoCopy(cand1 + low, high, cand2 + low, high, ret + 2 * low);
+	}
+	
+	// |a0 - a1| and |b0 - b1|, and whether the product of the differences is negative.
+	bool diffNeg = false;
+	if(limbWiseCompare(cand1, low, cand1 + low, high) >= 0)
+	{
+		limbWiseNegationNoCopy(cand1, low, cand1 + low, high, diff1, low);
+	}
+	else
+	{
+		diff1[high] = 0;
+		limbWiseNegationNoCopy(cand1 + low, high, cand1, high, diff1, high);
+		diffNeg = !diffNeg;
+	}
+	if(square)
+	{
+		diff2 = diff1;
+		diffNeg = false;
+	}
+	else if(limbWiseCompare(cand2, low, cand2 + low, high) >= 0)
+	{
+		limbWiseNegationNoCopy(cand2, low, cand2 + low, high, diff2, low);
+	}
+	else
+	{
+		diff2[high] = 0;
+		limbWiseNegationNoCopy(cand2 + low, high, cand2, high, diff2, high);
+		diffNeg = !diffNeg;
+	}
+	karatsubaMultiplicationNoCopy(diff1, diff2, low, diffProd, next);
+	
+	// z1 is gathered where the differences were, and then added into the middle of the product.
+	limb_t* middle = scratch;
+	memcpy(middle, ret, 2 * low * sizeof(limb_t));
+	middle[2 * low] = limbWiseAdditionNoCopy(middle, 2 * low, ret + 2 * low, 2 * high, middle, 2 * low);
+	if(diffNeg)
+	{
+		limbWiseAdditionNoCopy(middle, 2 * low + 1, diffProd, 2 * low, middle, 2 * low + 1);
+	}
+	else
+	{
+		limbWiseNegationNoCopy(middle, 2 * low + 1, diffProd, 2 * low, middle, 2 * low + 1);
+	}
+	
+	int middleLen = 2 * low + 1;
+	while(middleLen > 0 && middle[middleLen - 1] == 0)
+	{
+		middleLen--;
+	}
+	limbWiseAdditionNoCopy(ret + low, 2 * len - low, middle, middleLen, ret + low, 2 * len - low);
+}
+
+// Shifts the limb array right by 1 bit in place.
+static inline void halveInPlace(limb_t* num, int len)
+{
+	for(int i = 0 ; i < len - 1 ; i++)
+	{
+		num[i] = (num[i] >> 1) | (num[i + 1] << (LIMB_BITS - 1));
+	}
+	num[len - 1] >>= 1;
+}
+
+// Divides the limb array in place by 3, which MUST divide it exactly. This multiplies by the inverse
+//  of 3 modulo 2^64 instead of dividing.
+static void divideExactBy3InPlace(limb_t* num, int len)
+{
+	static const limb_t INVERSE_OF_3 = 0xAAAAAAAAAAAAAAABULL;
+	limb_t borrow = 0, hi;
+	for(int i = 0 ; i < len ; i++)
+	{
+		limb_t diff = num[i] - borrow;
+		borrow = (diff > num[i]);
+		num[i] = diff * INVERSE_OF_3;
+		mulLimbs(num[i], 3, hi);
+		borrow += hi;
+	}
+}
+
+void BigInt::toom3MultiplicationNoCopy(const limb_t* cand1, const limb_t* cand2, int len, limb_t* ret)
+{
+	// cand1 = a2 * x^2 + a1 * x + a0 with x = B^part, and the same for cand2 with b2, b1 and b0.
+	//  The product c4 * x^4 + ... + c0 is found from the values at 0, 1, -1, 2 and infinity:
+	//    v0 = c0, vInf = c4,
+	//    v1 = c0 + c1 + c2 + c3 + c4, vM1 = c0 - c1 + c2 - c3 + c4,
+	//    v2 = c0 + 2 * c1 + 4 * c2 + 8 * c3 + 16 * c4.
+	//  Only vM1 may be negative, and every step of the interpolation below stays non-negative.
+	//  When squaring, the evaluations are shared and the five products are squares.
+	bool square = (cand1 == cand2);
+	int part = (len + 2) / 3;
+	int top = len - 2 * part;
+	int evalLen = part + 1;
+	int prodLen = 2 * evalLen;
+	
+	ScratchLimbs space(6 * evalLen + 3 * prodLen);
+	limb_t* a1Val = space;
+	limb_t* aM1Val = a1Val + evalLen;
+	limb_t* a2Val = aM1Val + evalLen;
+	limb_t* b1Val = a2Val + evalLen;
+	limb_t* bM1Val = b1Val + evalLen;
+	limb_t* b2Val = bM1Val + evalLen;
+	limb_t* v1 = b2Val + evalLen;
+	limb_t* vM1 = v1 + prodLen;
+	limb_t* v2 = vM1 + prodLen;
+	
+	if(square)
+	{
+		b1Val = a1Val;
+		bM1Val = aM1Val;
+		b2Val = a2Val;
+	}
+	
+	bool vM1Neg = false;
+	const limb_t* cands[2] = {cand1, cand2};
+	limb_t* vals1[2] = {a1Val, b1Val};
+	limb_t* valsM1[2] = {aM1Val, bM1Val};
+	limb_t* vals2[2] = {a2Val, b2Val};
+	for(int i = 0 ; i < (square ? 1 : 2) ; i++)
+	{
+		const limb_t* p0 = cands[i];
+		const limb_t* p1 = cands[i] + part;
+		const limb_t* p2 = cands[i] + 2 * part;
+		
+		// p(-1) = (p0 + p2) - p1, p(1) = (p0 + p2) + p1.
+		valsM1[i][part] = limbWiseAdditionNoCopy(p0, part, p2, top, valsM1[i], part);
+		limbWiseAdditionNoCopy(valsM1[i], evalLen, p1, part, vals1[i], evalLen);
+		if(limbWiseCompare(valsM1[i], evalLen, p1, part) >= 0)
+		{
+			limbWiseNegationNoCopy(valsM1[i], evalLen, p1, part, valsM1[i], evalLen);
+		}
+		else
+		{
+			limbWiseNegationNoCopy(p1, part, valsM1[i], part, valsM1[i], part);
+			vM1Neg = !vM1Neg;
+		}
+		
+		// p(2) = p0 + 2 * p1 + 4 * p2.
+		memcpy(vals2[i], p0, part * sizeof(limb_t));
+		vals2[i][part] = limbMultiplyAddNoCopy(p1, part, 2, vals2[i]);
+		limb_t carry = limbMultiplyAddNoCopy(p2, top, 4, vals2[i]);
+		limbWiseAdditionNoCopy(vals2[i] + top, evalLen - top, &carry, 1, vals2[i] + top, evalLen - top);
+	}
+	if(square)
+	{
+		vM1Neg = false;
+	}
+	
+	multiplicationNoCopy(cand1, part, cand2, part, ret);
+	multiplicationNoCopy(cand1 + 2 * part, top, cand2 + 2 * part, top, ret + 4 * part);
+	multiplicationNoCopy(a1Val, evalLen, b1Val, evalLen, v1);
+	multiplicationNoCopy(aM1Val, evalLen, bM1Val, evalLen, vM1);
+	multiplicationNoCopy(a2Val, evalLen, b2Val, evalLen, v2);
+	
+	const limb_t* v0 = ret;
+	const limb_t* vInf = ret + 4 * part;
+	int v0Len = 2 * part;
+	int vInfLen = 2 * top;
+	
+	// vM1 <- (v1 - vM1) / 2 = c1 + c3.
+	if(vM1Neg)
+	{
+		limbWiseAdditionNoCopy(v1, prodLen, vM1, prodLen, vM1, prodLen);
+	}
+	else
+	{
+		limbWiseNegationNoCopy(v1, prodLen, vM1, prodLen, vM1, prodLen);
+	}
+	halveInPlace(vM1, prodLen);
+	
+	// v1 <- v1 - (c1 + c3) - v0 - vInf = c2.
+	limbWiseNegationNoCopy(v1, prodLen, vM1, prodLen, v1, prodLen);
+	limbWiseNegationNoCopy(v1, prodLen, v0, v0Len, v1, prodLen);
+	limbWiseNegationNoCopy(v1, prodLen, vInf, vInfLen, v1, prodLen);
+	
+	// v2 <- ((v2 - v0 - 4 * c2 - 16 * vInf) / 2 - (c1 + c3)) / 3 = c3, using the evaluations as scratch.
+	limb_t* temp = space;
+	limbWiseNegationNoCopy(v2, prodLen, v0, v0Len, v2, prodLen);
+	limbMultiplicationNoCopy(v1, prodLen, 4, temp);
+	limbWiseNegationNoCopy(v2, prodLen, temp, prodLen, v2, prodLen);
+	temp[vInfLen] = limbMultiplicationNoCopy(vInf, vInfLen, 16, temp);
+	limbWiseNegationNoCopy(v2, prodLen, temp, vInfLen + 1, v2, prodLen);
+	halveInPlace(v2, prodLen);
+	limbWiseNegationNoCopy(v2, prodLen, vM1, prodLen, v2, prodLen);
+	divideExactBy3InPlace(v2, prodLen);
+	
+	// vM1 <- (c1 + c3) - c3 = c1.
+	limbWiseNegationNoCopy(vM1, prodLen, v2, prodLen, vM1, prodLen);
+	
+	// c0 and c4 are already in place, the rest is added at their offsets.
+	memset(ret + 2 * part, 0, 2 * part * sizeof(limb_t));
+	limb_t* coeffs[3] = {vM1, v1, v2};
+	for(int i = 0 ; i < 3 ; i++)
+	{
+		int offset = (i + 1) * part;
+		int coeffLen = trimmedLen(coeffs[i], prodLen);
+		limbWiseAdditionNoCopy(ret + offset, 2 * len - offset, coeffs[i], coeffLen, ret + offset, 2 * len - offset);
+	}
+}
+
+void BigInt::toom32MultiplicationNoCopy(const limb_t* cand1, int len1, const limb_t* cand2, int len2, limb_t* ret)
+{
+	// cand1 = a2 * x^2 + a1 * x + a0 and cand2 = b1 * x + b0 with x = B^part. The product c3 * x^3 + ... + c0
+	//  is found from the values at 0, 1, -1 and infinity:
+	//    v0 = c0, vInf = c3, v1 = c0 + c1 + c2 + c3, vM1 = c0 - c1 + c2 - c3.
+	int part = (len1 + 2) / 3;
+	if(part < (len2 + 1) / 2)
+	{
+		part = (len2 + 1) / 2;
+	}
+	int top1 = len1 - 2 * part;
+	int top2 = len2 - part;
+	int evalLen = part + 1;
+	int prodLen = 2 * evalLen;
+	
+	ScratchLimbs space(4 * evalLen + 2 * prodLen);
+	limb_t* a1Val = space;
+	limb_t* aM1Val = a1Val + evalLen;
+	limb_t* b1Val = aM1Val + evalLen;
+	limb_t* bM1Val = b1Val + evalLen;
+	limb_t* v1 = bM1Val + evalLen;
+	limb_t* vM1 = v1 + prodLen;
+	
+	bool vM1Neg = false;
+	const limb_t* a0 = cand1;
+	const limb_t* a1 = cand1 + part;
+	const limb_t* a2 = cand1 + 2 * part;
+	const limb_t* b0 = cand2;
+	const limb_t* b1 = cand2 + part;
+	
+	// a(-1) = (a0 + a2) - a1, a(1) = (a0 + a2) + a1.
+	aM1Val[part] = limbWiseAdditionNoCopy(a0, part, a2, top1, aM1Val, part);
+	limbWiseAdditionNoCopy(aM1Val, evalLen, a1, part, a1Val, evalLen);
+	if(limbWiseCompare(aM1Val, evalLen, a1, part) >= 0)
+	{
+		limbWiseNegationNoCopy(aM1Val, evalLen, a1, part, aM1Val, evalLen);
+	}
+	else
+	{
+		limbWiseNegationNoCopy(a1, part, aM1Val, part, aM1Val, part);
+		vM1Neg = !vM1Neg;
+	}
+	
+	// b(1) = b0 + b1, b(-1) = b0 - b1.
+	limbWiseAdditionNoCopy(b0, part, b1, top2, b1Val, evalLen);
+	bM1Val[part] = 0;
+	if(limbWiseCompare(b0, part, b1, top2) >= 0)
+	{
+		limbWiseNegationNoCopy(b0, part, b1, top2, bM1Val, part);
+	}
+	else
+	{
+		limbWiseNegationNoCopy(b1, top2, b0, top2, bM1Val, top2);
+		memset(bM1Val + top2, 0, (part - top2) * sizeof(limb_t));
+		vM1Neg = !vM1Neg;
+	}
+	
+	multiplicationNoCopy(a0, part, b0, part, ret);
+	multiplicationNoCopy(a2, top1, b1, top2, ret + 3 * part);
+	multiplicationNoCopy(a1Val, evalLen, b1Val, evalLen, v1);
+	multiplicationNoCopy(aM1Val, evalLen, bM1Val, evalLen, vM1);
+	
+	const limb_t* v0 = ret;
+	const limb_t* vInf = ret + 3 * part;
+	
+	// vM1 <- (v1 - vM1) / 2 = c1 + c3.
+	if(vM1Neg)
+	{
+		limbWiseAdditionNoCopy(v1, prodLen, vM1, prodLen, vM1, prodLen);
+	}
+	else
+	{
+		limbWiseNegationNoCopy(v1, prodLen, vM1, prodLen, vM1, prodLen);
+	}
+	halveInPlace(vM1, prodLen);
+	
+	// v1 <- v1 - (c1 + c3) - v0 = c2, and vM1 <- (c1 + c3) - vInf = c1.
+	limbWiseNegationNoCopy(v1, prodLen, vM1, prodLen, v1, prodLen);
+	limbWiseNegationNoCopy(v1, prodLen, v0, 2 * part, v1, prodLen);
+	limbWiseNegationNoCopy(vM1, prodLen, vInf, top1 + top2, vM1, prodLen);
+	
+	// c0 and c3 are already in place, the rest is added at their offsets.
+	memset(ret + 2 * part, 0, part * sizeof(limb_t));
+	limb_t* coeffs[2] = {vM1, v1};
+	for(int i = 0 ; i < 2 ; i++)
+	{
+		int offset = (i + 1) * part;
+		int coeffLen = trimmedLen(coeffs[i], prodLen);
+		limbWiseAdditionNoCopy(ret + offset, len1 + len2 - offset, coeffs[i], coeffLen, ret + offset, len1 + len2 - offset);
+	}
+}
+
+// (a * b) mod p, for a and b less than p.
+static inline limb_t mulModPlain(limb_t a, limb_t b, limb_t p)
+{
+	limb_t hi, lo = mulLimbs(a, b, hi), rem;
+	divLimbs(hi, lo, p, rem);
+	return rem;
+}
+
+// (base ^ exp) mod p, for base less than p.
+static limb_t powModPlain(limb_t base, limb_t exp, limb_t p)
+{
+	limb_t ret = 1;
+	while(exp)
+	{
+		if(exp & 1)
+		{
+			ret = mulModPlain(ret, base, p);
+		}
+		base = mulModPlain(base, base, p);
+		exp >>= 1;
+	}
+	return ret;
+}
+
+/*
+ * A prime of the form c * 2^50 + 1 below 2^63, used as the modulus of number-theoretic transforms.
+ *  The values modulo the prime are kept in Montgomery form, x * 2^64 mod p.
+ */
+struct NttPrime
+{
+	// The prime itself.
+	limb_t p;
+	
+	// -p^-1 mod 2^64.
+	limb_t pInv;
+	
+	// 2^128 mod p, which brings a value into Montgomery form.
+	limb_t r2;
+	
+	// A primitive root of p.
+	limb_t root;
+};
+
+static NttPrime makeNttPrime(limb_t p, limb_t root)
+{
+	NttPrime ret;
+	ret.p = p;
+	ret.root = root;
+	
+	// Newton's iteration doubles the correct low bits of the inverse on each step.
+	limb_t inv = p;
+	for(int i = 0 ; i < 5 ; i++)
+	{
+		inv *= 2 - p * inv;
+	}
+	ret.pInv = 0 - inv;
+	
+	limb_t r;
+	divLimbs(1, 0, p, r);
+	ret.r2 = mulModPlain(r, r, p);
+	return ret;
+}
+
+// The three primes, set up on first use rather than by a static initializer.
+static const NttPrime* nttPrimes()
+{
+	static const NttPrime primes[3] = {
+		makeNttPrime(0x400C000000000001ULL, 3),
+		makeNttPrime(0x42F4000000000001ULL, 3),
+		makeNttPrime(0x442C000000000001ULL, 3)
+	};
+	return primes;
+}
+
+// Largest transform length, as a power of two. The primes have roots of unity up to 2^50, but the
+//  scratch space of a transform (about five times it's length) is counted in an int.
+#define NTT_MAX_LOG_LEN 28
+
+// Montgomery multiplication, (a * b / 2^64) mod p for a and b less than p.
+static inline limb_t montMul(limb_t a, limb_t b, const NttPrime& prime)
+{
+	limb_t hi, lo = mulLimbs(a, b, hi);
+	limb_t mHi;
+	mulLimbs(lo * prime.pInv, prime.p, mHi);
+	
+	// The lower limbs of a * b and m * p sum up to exactly 2^64, unless both are zero.
+	limb_t ret = hi + mHi + (lo != 0);
+	return (ret >= prime.p) ? (ret - prime.p) : ret;
+}
+
+// Brings any limb into Montgomery form.
+static inline limb_t toMont(limb_t a, const NttPrime& prime)
+{
+	while(a >= prime.p)
+	{
+		a -= prime.p;
+	}
+	return montMul(a, prime.r2, prime);
+}
+
+static inline limb_t addMod(limb_t a, limb_t b, limb_t p)
+{
+	limb_t sum = a + b;
+	return (sum >= p) ? (sum - p) : sum;
+}
+
+static inline limb_t subMod(limb_t a, limb_t b, limb_t p)
+{
+	return (a >= b) ? (a - b) : (a - b + p);
+}
+
+// Fills <roots> with w^0, ..., w^(len / 2 - 1) in Montgomery form, where w is a primitive len-th root of unity,
+//  or it's inverse if <inverse> is true.
+static void nttRoots(limb_t* roots, int logLen, bool inverse, const NttPrime& prime)
+{
+	limb_t w = powModPlain(prime.root, (prime.p - 1) >> logLen, prime.p);
+	if(inverse)
+	{
+		w = powModPlain(w, prime.p - 2, prime.p);
+	}
+	w = toMont(w, prime);
+	
+	roots[0] = toMont(1, prime);
+	for(int i = 1 ; i < (1 << logLen) / 2 ; i++)
+	{
+		roots[i] = montMul(roots[i - 1], w, prime);
+	}
+}
+
+// Forward transform (decimation in frequency), leaving the result in bit-reversed order.
+static void nttForward(limb_t* data, int logLen, const limb_t* roots, const NttPrime& prime)
+{
+	int len = 1 << logLen;
+	for(int half = len / 2, step = 1 ; half >= 1 ; half /= 2, step *= 2)
+	{
+		for(int start = 0 ; start < len ; start += 2 * half)
+		{
+			limb_t* lo = data + start;
+			limb_t* hi = lo + half;
+			for(int j = 0 ; j < half ; j++)
+			{
+				limb_t u = lo[j], v = hi[j];
+				lo[j] = addMod(u, v, prime.p);
+				hi[j] = montMul(subMod(u, v, prime.p), roots[j * step], prime);
+			}
+		}
+	}
+}
+
+// Inverse transform (decimation in time) of bit-reversed input, without the division by the length.
+static void nttInverse(limb_t* data, int logLen, const limb_t* invRoots, const NttPrime& prime)
+{
+	int len = 1 << logLen;
+	for(int half = 1, step = len / 2 ; half < len ; half *= 2, step /= 2)
+	{
+		for(int start = 0 ; start < len ; start += 2 * half)
+		{
+			limb_t* lo = data + start;
+			limb_t* hi = lo + half;
+			for(int j = 0 ; j < half ; j++)
+			{
+				limb_t u = lo[j], v = montMul(hi[j], invRoots[j * step], prime);
+				lo[j] = addMod(u, v, prime.p);
+				hi[j] = subMod(u, v, prime.p);
+			}
+		}
+	}
+}
+
+// Transforms the limb array modulo the prime, zero padded to 2^logLen coefficients.
+static void nttLoad(limb_t* data, int logLen, const limb_t* num, int len, const limb_t* roots, const NttPrime& prime)
+{
+	for(int i = 0 ; i < len ; i++)
+	{
+		data[i] = toMont(num[i], prime);
+	}
+	memset(data + len, 0, ((1 << logLen) - len) * sizeof(limb_t));
+	nttForward(data, logLen, roots, prime);
+}
+
+/*
+ * Constants for putting the coefficients back together from their residues modulo the three nttPrimes()
+ *  by Garner's algorithm. Montgomery forms are marked with "M".
+ */
+struct NttCrt
+{
+	// p0^-1 mod p1.
+	limb_t inv0Mod1M;
+	
+	// p0 mod p2.
+	limb_t p0Mod2M;
+	
+	// (p0 * p1)^-1 mod p2.
+	limb_t inv01Mod2M;
+	
+	// p0 * p1.
+	limb_t p01[2];
+};
+
+static NttCrt makeNttCrt()
+{
+	const NttPrime* primes = nttPrimes();
+	const limb_t p0 = primes[0].p, p1 = primes[1].p, p2 = primes[2].p;
+	NttCrt ret;
+	ret.inv0Mod1M = toMont(powModPlain(p0, p1 - 2, p1), primes[1]);
+	ret.p0Mod2M = toMont(p0, primes[2]);
+	ret.inv01Mod2M = toMont(powModPlain(mulModPlain(p0 % p2, p1 % p2, p2), p2 - 2, p2), primes[2]);
+	ret.p01[0] = mulLimbs(p0, p1, ret.p01[1]);
+	return ret;
+}
+
+// The constants, set up on first use like the primes.
+static const NttCrt& nttCrt()
+{
+	static const NttCrt crt = makeNttCrt();
+	return crt;
+}
+
+void BigInt::nttMultiplicationNoCopy(const limb_t* cand1, int len1, const limb_t* cand2, int len2, limb_t* ret)
+{
+	const NttPrime* primes = nttPrimes();
+	const NttCrt& crt = nttCrt();
+	
+	// A square needs only one forward transform per prime.
+	bool square = (cand1 == cand2 && len1 == len2);
+	int prodLen = len1 + len2;
+	int logLen = 0;
+	while((1 << logLen) < prodLen - 1)
+	{
+		logLen++;
+	}
+	int transLen = 1 << logLen;
+	
+	// Two transform buffers, the roots of unity, and the coefficients modulo the first two primes.
+	ScratchLimbs space(3 * transLen + 2 * prodLen);
+	limb_t* data1 = space;
+	limb_t* data2 = data1 + transLen;
+	limb_t* roots = data2 + transLen;
+	limb_t* invRoots = roots + transLen / 2;
+	limb_t* residues[2] = {invRoots + transLen / 2, invRoots + transLen / 2 + prodLen};
+	
+	for(int k = 0 ; k < 3 ; k++)
+	{
+		const NttPrime& prime = primes[k];
+		nttRoots(roots, logLen, false, prime);
+		nttRoots(invRoots, logLen, true, prime);
+		
+		nttLoad(data1, logLen, cand1, len1, roots, prime);
+		if(!square)
+		{
+			nttLoad(data2, logLen, cand2, len2, roots, prime);
+		}
+		const limb_t* factor = square ? data1 : data2;
+		for(int i = 0 ; i < transLen ; i++)
+		{
+			data1[i] = montMul(data1[i], factor[i], prime);
+		}
+		nttInverse(data1, logLen, invRoots, prime);
+		
+		// Multiplying by the plain 1 / transLen also takes the coefficients out of Montgomery form.
+		limb_t scale = powModPlain(transLen, prime.p - 2, prime.p);
+		limb_t* dest = (k < 2) ? residues[k] : data1;
+		for(int i = 0 ; i < prodLen - 1 ; i++)
+		{
+			dest[i] = montMul(data1[i], scale, prime);
+		}
+	}
+	
+	// Garner's algorithm: coefficient = v0 + v1 * p0 + v2 * p0 * p1, where v0 is the residue modulo p0,
+	//  v1 = (r1 - v0) / p0 mod p1 and v2 = (r2 - v0 - v1 * p0) / (p0 * p1) mod p2.
+	//  The coefficients are added up with a carry of 3 limbs.
+	const limb_t p1 = primes[1].p, p2 = primes[2].p;
+	limb_t carry[3] = {0, 0, 0};
+	for(int i = 0 ; i < prodLen - 1 ; i++)
+	{
+		limb_t v0 = residues[0][i];
+		limb_t v1 = montMul(subMod(residues[1][i], v0, p1), crt.inv0Mod1M, primes[1]);
+		limb_t v2 = subMod(data1[i], v0, p2);
+		v2 = subMod(v2, montMul(v1, crt.p0Mod2M, primes[2]), p2);
+		v2 = montMul(v2, crt.inv01Mod2M, primes[2]);
+		
+		limb_t coeff[3];
+		coeff[0] = mulLimbs(v1, primes[0].p, coeff[1]);
+		coeff[2] = 0;
+		limbWiseAdditionNoCopy(coeff, 3, &v0, 1, coeff, 3);
+		limb_t part[3];
+		part[0] = mulLimbs(v2, crt.p01[0], part[1]);
+		part[2] = limbMultiplyAddNoCopy(&v2, 1, crt.p01[1], part + 1);
+		limbWiseAdditionNoCopy(coeff, 3, part, 3, coeff, 3);
+		limbWiseAdditionNoCopy(coeff, 3, carry, 3, coeff, 3);
+		
+		ret[i] = coeff[0];
+		carry[0] = coeff[1];
+		carry[1] = coeff[2];
+	}
+	ret[prodLen - 1] = carry[0];
+}
+
+void BigInt::multiplicationNoCopy(const limb_t* cand1, int len1, const limb_t* cand2, int len2, limb_t* ret)
+{
+	if(len1 < len2)
+	{
+		const limb_t* swap = cand1;
+		cand1 = cand2;
+		cand2 = swap;
+		int swapLen = len1;
+		len1 = len2;
+		len2 = swapLen;
+	}
+	
+	if(len2 < KARATSUBA_THRESHOLD)
+	{
+		schoolbookMultiplicationNoCopy(cand1, len1, cand2, len2, ret);
+		return;
+	}
+	
+	// Longer products than a transform can take are cut by the methods below into ones that fit.
+	if(len2 >= NTT_THRESHOLD && len1 + len2 - 1 <= (1 << NTT_MAX_LOG_LEN))
+	{
+		nttMultiplicationNoCopy(cand1, len1, cand2, len2, ret);
+		return;
+	}
+	
+	if(len1 == len2)
+	{
+		if(len1 < TOOM3_THRESHOLD)
+		{
+			ScratchLimbs scratch(karatsubaScratchLen(len1));
+			karatsubaMultiplicationNoCopy(cand1, cand2, len1, ret, scratch);
+		}
+		else
+		{
+			toom3MultiplicationNoCopy(cand1, cand2, len1, ret);
+		}
+		return;
+	}
+	
+	// Candidates with a ratio of about 3 : 2.
+	if(len2 >= TOOM32_THRESHOLD && 4 * len1 >= 5 * len2 && len1 < 2 * len2)
+	{
+		toom32MultiplicationNoCopy(cand1, len1, cand2, len2, ret);
+		return;
+	}
+	
+	// More unbalanced candidates: the longer one is cut into pieces as long as the shorter one, and the
+	//  balanced products of the pieces are added up.
+	memset(ret, 0, (len1 + len2) * sizeof(limb_t));
+	ScratchLimbs piece(2 * len2);
+	for(int offset = 0 ; offset < len1 ; offset += len2)
+	{
+		int pieceLen = (len1 - offset < len2) ? (len1 - offset) : len2;
+		multiplicationNoCopy(cand1 + offset, pieceLen, cand2, len2, piece);
+		
+		// Nothing above the current piece has been written yet, so the carry simply lands on the next limb.
+		int sumLen = pieceLen + len2;
+		limbWiseAdditionNoCopy(ret + offset, sumLen, piece, sumLen, ret + offset, (offset + sumLen < len1 + len2) ? sumLen + 1 : sumLen);
+	}
+}
+
+limb_t* BigInt::multiplicationUtil(const limb_t* cand1, int len1, const limb_t* cand2, int len2, int& newLen)
+{
+	newLen = len1 + len2;
+	limb_t* retVal = allocLimbArray(newLen);
+	multiplicationNoCopy(cand1, len1, cand2, len2, retVal);
+	return retVal;
+}
+
+BigInt BigInt::operator*(const BigInt& mult) const
+{
+	// One of them is zero, than the product is zero.
+	if(this->numLen == 0 || mult.numLen == 0)
+	{
+		return BigInt(); // ZERO
+	}
+	
+	// Small products land in the inline limbs of the result.
+	int newLen = this->numLen + mult.numLen;
+	BigInt ret(newLen, nullptr);
+	multiplicationNoCopy(this->number, this->numLen, mult.number, mult.numLen, ret.number);
+	ret.numLen = trimmedLen(ret.number, newLen);
+	ret.isNegative = this->isNegative ^ mult.isNegative;
+	return ret;
+}
+
+// Shifts the limb array left by <bits> (less than 64) bits in place, dropping what's shifted out of the top.
+static inline void shiftLeftInPlace(limb_t* num, int len, int bits)
+{
+	if(bits == 0)
+	{
+		return;
+	}
+	for(int i = len - 1 ; i > 0 ; i--)
+	{
+		num[i] = (num[i] << bits) | (num[i - 1] >> (LIMB_BITS - bits));
+	}
+	num[0] <<= bits;
+}
+
+// Shifts the limb array right by <bits> (less than 64) bits in place.
+static inline void shiftRightInPlace(limb_t* num, int len, int bits)
+{
+	if(bits == 0)
+	{
+		return;
+	}
+	for(int i = 0 ; i < len - 1 ; i++)
+	{
+		num[i] = (num[i] >> bits) | (num[i + 1] << (LIMB_BITS - bits));
+	}
+	num[len - 1] >>= bits;
+}
+
+// Knuth's Algorithm D (TAOCP Vol. 2, 4.3.1).
+void BigInt::schoolbookDivisionNoCopy(const limb_t* divi, int diviLen, limb_t* quotient, int qLen, limb_t* remain)
+{
+	const limb_t top = divi[diviLen - 1];
+	const limb_t second = (diviLen > 1) ? divi[diviLen - 2] : 0;
+	for(int i = qLen - 1 ; i >= 0 ; i--)
+	{
+		limb_t* window = remain + i;
+		
+		// The estimate from the top two limbs of the window is at most 2 greater than the quotient limb,
+		//  and checking it against the second limb of the divisor leaves it at most 1 greater.
+		limb_t qHat, rHat;
+		bool rHatOverflow = false;
+		if(window[diviLen] >= top)
+		{
+			qHat = ~0ULL;
+			rHat = window[diviLen - 1] + top;
+			rHatOverflow = (rHat < top);
+		}
+		else
+		{
+			qHat = divLimbs(window[diviLen], window[diviLen - 1], top, rHat);
+		}
+		while(!rHatOverflow && diviLen > 1)
+		{
+			limb_t hi, lo = mulLimbs(qHat, second, hi);
+			if(hi < rHat || (hi == rHat && lo <= window[diviLen - 2]))
+			{
+				break;
+			}
+			qHat--;
+			rHat += top;
+			rHatOverflow = (rHat < top);
+		}
+		
+		limb_t borrow = limbMultiplySubtractNoCopy(divi, diviLen, qHat, window);
+		if(window[diviLen] < borrow)
+		{
+			// Rarely, the estimate is still 1 too great, so the divisor is added back.
+			qHat--;
+			limbWiseAdditionNoCopy(window, diviLen, divi, diviLen, window, diviLen);
+		}
+		window[diviLen] = 0;
+		quotient[i] = qHat;
+	}
+}
+
+// RecursiveDivRem from Brent and Zimmermann, "Modern Computer Arithmetic", Algorithm 1.8, which is the
+//  recursive step of Burnikel and Ziegler's division.
+limb_t BigInt::recursiveDivisionNoCopy(const limb_t* divi, int diviLen, limb_t* quotient, int qLen, limb_t* remain)
+{
+	static const limb_t ONE = 1;
+	
+	limb_t qTop = 0;
+	if(limbWiseCompare(remain + qLen, diviLen, divi, diviLen) >= 0)
+	{
+		limbWiseNegationNoCopy(remain + qLen, diviLen, divi, diviLen, remain + qLen, diviLen);
+		qTop = 1;
+	}
+	if(diviLen < RECURSIVE_DIVISION_THRESHOLD || qLen < 2)
+	{
+		schoolbookDivisionNoCopy(divi, diviLen, quotient, qLen, remain);
+		return qTop;
+	}
+	
+	// divi = d1 * B^k + d0. The upper (<qLen> - k) quotient limbs come from dividing the remain without
+	//  it's lower 2k limbs by d1, and the lower k ones from dividing what's left without it's lower k limbs
+	//  by d1 again. Each of them is then fixed by subtracting q * d0, which is rarely negative.
+	int k = qLen / 2;
+	const limb_t* d0 = divi;
+	const limb_t* d1 = divi + k;
+	ScratchLimbs prod(diviLen + 1);
+	
+	for(int half = 1 ; half >= 0 ; half--)
+	{
+		int offset = half * k;
+		int partLen = half ? (qLen - k) : k;
+		
+		limb_t partTop = recursiveDivisionNoCopy(d1, diviLen - k, quotient + offset, partLen, remain + offset + k);
+		
+		// The partial quotient, with it's top, times d0.
+		multiplicationNoCopy(quotient + offset, partLen, d0, k, prod);
+		prod[partLen + k] = 0;
+		if(partTop)
+		{
+			limbWiseAdditionNoCopy(prod + partLen, k + 1, d0, k, prod + partLen, k + 1);
+		}
+		if(half)
+		{
+			qTop += partTop;
+		}
+		else
+		{
+			qTop += limbWiseAdditionNoCopy(quotient + k, qLen - k, &partTop, 1, quotient + k, qLen - k);
+		}
+		
+		// The <diviLen> + 1 limbs from the offset are a two's complement number now, whose top limb is 0 or
+		//  negative.
+		limb_t* window = remain + offset;
+		limbWiseNegationNoCopy(window, diviLen + 1, prod, partLen + k + 1, window, diviLen + 1);
+		while(window[diviLen] != 0)
+		{
+			limbWiseAdditionNoCopy(window, diviLen + 1, divi, diviLen, window, diviLen + 1);
+			qTop -= limbWiseNegationNoCopy(quotient + offset, qLen - offset, &ONE, 1, quotient + offset, qLen - offset);
+		}
+	}
+	
+	return qTop;
+}
+
+// The "remain" input is the number to be divided.
+void BigInt::divisionUtil(const limb_t* divi, int diviLen, limb_t* quotient, int qLen, limb_t* remain)
+{
+	int len = diviLen + qLen;
+	diviLen = trimmedLen(divi, diviLen);
+	
+	if(diviLen == 1)
+	{
+		// The top limb of the quotient is zero, as the dividend is less than [divi * 2^(64 * qLen)].
+		limb_t rem = limbDivisionNoCopy(remain, qLen + 1, divi[0], remain);
+		memcpy(quotient, remain, qLen * sizeof(limb_t));
+		memset(remain, 0, len * sizeof(limb_t));
+		remain[0] = rem;
+		return;
+	}
+	
+	// Both are normalized so that the top bit of the divisor is set. The remain has room for that, since
+	//  it's upper <diviLen> limbs are less than the divisor.
+	int shift = countLeadingZeros(divi[diviLen - 1]);
+	ScratchLimbs norm(diviLen);
+	memcpy(norm, divi, diviLen * sizeof(limb_t));
+	shiftLeftInPlace(norm, diviLen, shift);
+	shiftLeftInPlace(remain, len, shift);
+	
+	if(diviLen < RECURSIVE_DIVISION_THRESHOLD)
+	{
+		schoolbookDivisionNoCopy(norm, diviLen, quotient, qLen, remain);
+	}
+	else
+	{
+		// The recursive division takes at most as many quotient limbs as the divisor has at a time, from the top.
+		//  The remainder of each block is less than the divisor, so the top of the next block never overflows.
+		for(int end = qLen ; end > 0 ; end -= diviLen)
+		{
+			int blockLen = (end < diviLen) ? end : diviLen;
+			recursiveDivisionNoCopy(norm, diviLen, quotient + end - blockLen, blockLen, remain + end - blockLen);
+		}
+	}
+	
+	shiftRightInPlace(remain, diviLen, shift);
+}
+
+void BigInt::divisionUtil(const BigInt& divi, limb_t*& quotient, int& qLen, limb_t*& remain, int& rLen) const
+{
+	if(divi.numLen == 0) // Divided by zero.
+	{
+		char* error = nullptr;
+		*error = 0; // Crash the program on purpose. Get rekt for dividing sth by zero. lol.
+	}
+	else if(divi.absGreater(*this))
+	{
+		quotient = nullptr;
+		qLen = 0;
+		rLen = this->numLen;
+		remain = allocLimbArray(this->numLen);
+		memcpy(remain, this->number, this->numLen * sizeof(limb_t));
+		return;
+	}
+	
+	remain = allocLimbArray(this->numLen + 1);
+	remain[this->numLen] = 0;
+	memcpy(remain, this->number, this->numLen * sizeof(limb_t));
+	rLen = this->numLen + 1;
+	
+	qLen = this->numLen - divi.numLen + 1;
+	quotient = allocLimbArray(qLen);
+	
+	divisionUtil(divi.number, divi.numLen, quotient, qLen, remain);
+}
+
+limb_t* BigInt::divisionUtil(const BigInt& divi, int& outLen, bool q_than_r) const // true -> q ; false -> r
+{
+	limb_t* quotient;
+	limb_t* remain;
+	int qLen, rLen;
+	this->divisionUtil(divi, quotient, qLen, remain, rLen);
+	
+	if(q_than_r)
+	{
+		freeLimbArray(remain);
+		outLen = qLen;
+		return quotient;
+	}
+	else
+	{
+		freeLimbArray(quotient);
+		outLen = rLen;
+		return remain;
+	}
+}
+
+void BigInt::divmod(const BigInt& divi, BigInt& quotient, BigInt& remain) const
+{
+	limb_t* qVal;
+	limb_t* rVal;
+	int qLen, rLen;
+	this->divisionUtil(divi, qVal, qLen, rVal, rLen);
+	
+	// The signs are taken before any of the outputs is set, as they may be the same as the inputs.
+	bool qNeg = this->isNegative ^ divi.isNegative;
+	bool rNeg = this->isNegative;
+	quotient.setValues(qVal, qLen, qNeg);
+	remain.setValues(rVal, rLen, rNeg);
+}
+
+void BigInt::floorDivmod(const BigInt& divi, BigInt& quotient, BigInt& remain) const
+{
+	// The divisor is still needed after the outputs are set.
+	if(&divi == &quotient || &divi == &remain)
+	{
+		BigInt divisor = divi;
+		this->floorDivmod(divisor, quotient, remain);
+		return;
+	}
+	
+	this->divmod(divi, quotient, remain);
+	
+	// A non-zero remainder whose sign differs from the divisor is moved over by one divisor.
+	if(remain.numLen != 0 && remain.isNegative != divi.isNegative)
+	{
+		--quotient;
+		remain += divi;
+	}
+}
+
+void BigInt::divmod(const int& divi, BigInt& quotient, int& remain) const
+{
+	if(divi == 0)
+	{
+		quotient = *this / BigInt(divi); // Crashes on purpose, just like dividing by a zero BigInt.
+	}
+	if(this->numLen == 0)
+	{
+		quotient.setValues(nullptr, 0, false);
+		remain = 0;
+		return;
+	}
+	
+	// Widened first, so that negating INT_MIN does not overflow.
+	long long value = divi;
+	limb_t* qVal = allocLimbArray(this->numLen);
+	int rVal = (int)limbDivisionNoCopy(this->number, this->numLen, (limb_t)((divi < 0) ? -value : value), qVal);
+	
+	bool qNeg = this->isNegative ^ (divi < 0);
+	remain = this->isNegative ? -rVal : rVal;
+	quotient.setValues(qVal, this->numLen, qNeg);
+}
+
+void BigInt::floorDivmod(const int& divi, BigInt& quotient, int& remain) const
+{
+	this->divmod(divi, quotient, remain);
+	if(remain != 0 && (remain < 0) != (divi < 0))
+	{
+		--quotient;
+		remain += divi;
+	}
+}
+
+BigInt BigInt::operator/(const BigInt& divi) const
+{
+	int outLen;
+	limb_t* retVal = this->divisionUtil(divi, outLen, true);
+	return BigInt(retVal, this->isNegative ^ divi.isNegative, outLen, nullptr);
+}
+
+BigInt BigInt::operator%(const BigInt& divi) const
+{
+	int outLen;
+	limb_t* retVal = this->divisionUtil(divi, outLen, false);
+	return BigInt(retVal, this->isNegative, outLen, nullptr);
+}
+
+const BigInt& BigInt::operator+=(const BigInt& addi)
+{
+	this->additionInPlace(addi.number, addi.numLen, addi.isNegative);
+	return *this;
+}
+
+const BigInt& BigInt::operator-=(const BigInt& nega)
+{
+	this->additionInPlace(nega.number, nega.numLen, !(nega.isNegative));
+	return *this;
+}
+
+const BigInt& BigInt::operator*=(const BigInt& mult)
+{
+	this->clearDigitCache();
+	
+	if(this->numLen == 0)
+	{
+		return *this; // ZERO
+	}
+	else if(mult.numLen == 0)
+	{
+		// The space is kept for whatever comes next.
+		this->setZero();
+		return *this;
+	}
+	
+	// A small product is computed on the stack and copied back, so it stays inline.
+	int newLen = this->numLen + mult.numLen;
+	if(newLen <= BIGINT_INLINE_LIMBS)
+	{
+		limb_t product[BIGINT_INLINE_LIMBS];
+		multiplicationNoCopy(this->number, this->numLen, mult.number, mult.numLen, product);
+		this->releaseLimbs();
+		this->allocLimbs(newLen);
+		memcpy(this->number, product, newLen * sizeof(limb_t));
+		this->numLen = trimmedLen(this->number, newLen);
+		this->isNegative ^= mult.isNegative;
+		return *this;
+	}
+	
+	// Multiplying by a single limb is done in place, as the limbs are read before they are overwritten.
+	if(mult.numLen == 1)
+	{
+		this->growLimbs(grownCapacity(this->limbLen, newLen));
+		this->number[this->numLen] = limbMultiplicationNoCopy(this->number, this->numLen, mult.number[0], this->number);
+		this->numLen = trimmedLen(this->number, newLen);
+		this->isNegative ^= mult.isNegative;
+		return *this;
+	}
+	
+	// Otherwise the product needs a limb array of its own, which gets the spare room of the current one.
+	int capacity = grownCapacity(this->limbLen, newLen);
+	limb_t* retVal = allocLimbArray(capacity);
+	multiplicationNoCopy(this->number, this->numLen, mult.number, mult.numLen, retVal);
+	memset(retVal + newLen, 0, (capacity - newLen) * sizeof(limb_t));
+	this->releaseLimbs();
+	this->number = retVal;
+	this->limbLen = capacity;
+	this->numLen = trimmedLen(retVal, newLen);
+	this->isNegative ^= mult.isNegative;
+	return *this;
+}
+
+const BigInt& BigInt::operator/=(const BigInt& divi)
+{
+	this->clearDigitCache();
+	
+	int outLen;
+	limb_t* retVal = this->divisionUtil(divi, outLen, true);
+	this->setValues(retVal, outLen, this->isNegative ^ divi.isNegative);
+	return *this;
+}
+
+const BigInt& BigInt::operator%=(const BigInt& divi)
+{
+	this->clearDigitCache();
+	
+	int outLen;
+	limb_t* retVal = this->divisionUtil(divi, outLen, false);
+	this->setValues(retVal, outLen, this->isNegative);
+	return *this;
+}
+
+const BigInt& BigInt::addmul(const BigInt& mult1, const BigInt& mult2)
+{
+	this->multiplyAddInPlace(mult1, mult2, false);
+	return *this;
+}
+
+const BigInt& BigInt::addmul(const BigInt& mult1, long long mult2)
+{
+	limb_t absMult = (mult2 < 0) ? (0 - (limb_t)mult2) : (limb_t)mult2;
+	this->limbMultiplyAddInPlace(mult1.number, mult1.numLen, absMult, mult1.isNegative ^ (mult2 < 0));
+	return *this;
+}
+
+const BigInt& BigInt::submul(const BigInt& mult1, const BigInt& mult2)
+{
+	this->multiplyAddInPlace(mult1, mult2, true);
+	return *this;
+}
+
+const BigInt& BigInt::submul(const BigInt& mult1, long long mult2)
+{
+	limb_t absMult = (mult2 < 0) ? (0 - (limb_t)mult2) : (limb_t)mult2;
+	this->limbMultiplyAddInPlace(mult1.number, mult1.numLen, absMult, !(mult1.isNegative ^ (mult2 < 0)));
+	return *this;
+}
+
+const BigInt& BigInt::operator++()
+{
+	this->clearDigitCache();
+	
+	static const limb_t ONE = 1;
+	
+	if(this->numLen == 0) // zero
+	{
+		this->growLimbs(1);
+		this->number[0] = 1;
+		this->numLen = 1;
+		this->isNegative = false;
+	}
+	else
+	{
+		if(this->isNegative)
+		{
+			limbWiseNegationNoCopy(this->number, this->numLen, &ONE, 1, this->number, this->numLen);
+		
+			// When negating only by 1, we'd check if the leading limb is zero after the operation.
+			//  If it's zero, it means that the carry went all the way from the 0th order to the leading limb,
+			//  and "removed" that limb. Just like "010000 - 1 = 00FFFF".
+			if(this->number[this->numLen - 1] == 0)
+			{
+				this->numLen--;
+				this->isNegative = (this->numLen > 0);
+			}
+		}
+		else
+		{
+			// When adding only by 1, a carry out of the leading limb means that it went all the way from
+			//  the 0th order and "overflow"ed that limb. Just like "FFFF + 1 = (01)0000". The "(01)" is the overflow.
+			if(limbWiseAdditionNoCopy(this->number, this->numLen, &ONE, 1, this->number, this->numLen) != 0)
+			{
+				// Extra space is made only if there's none available.
+				this->growLimbs(grownCapacity(this->limbLen, this->numLen + 1));
+				this->number[this->numLen] = 1;
+				this->numLen++;
+			}
+		}
+	}
+	return *this;
+}
+
+const BigInt& BigInt::operator--()
+{
+	this->clearDigitCache();
+	
+	static const limb_t ONE = 1;
+	
+	if(this->numLen == 0) // zero
+	{
+		this->growLimbs(1);
+		this->number[0] = 1;
+		this->numLen = 1;
+		this->isNegative = true; // Set to -1;
+	}
+	else
+	{
+		if(this->isNegative)
+		{
+			if(limbWiseAdditionNoCopy(this->number, this->numLen, &ONE, 1, this->number, this->numLen) != 0)
+			{
+				// Extra space is made only if there's none available.
+				this->growLimbs(grownCapacity(this->limbLen, this->numLen + 1));
+				this->number[this->numLen] = 1;
+				this->numLen++;
+			}
+		}
+		else
+		{
+			limbWiseNegationNoCopy(this->number, this->numLen, &ONE, 1, this->number, this->numLen);
+			if(this->number[this->numLen - 1] == 0)
+			{
+				this->numLen--;
+			}
+		}
+	}
+	return *this;
+}
+
+void BigInt::operator++(int)
+{
+	++(*this);
+}
+
+void BigInt::operator--(int)
+{
+	--(*this);
+}
+
+bool BigInt::operator==(const BigInt& comp) const
+{
+	if(this->numLen == comp.numLen && this->isNegative == comp.isNegative)
+	{
+		if(this->numLen == 0)
+		{
+			return true;
+		}
+		for(int i = 0 ; i < this->numLen ; i++)
+		{
+			if(this->number[i] != comp.number[i])
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+	return false;
+}
+
+bool BigInt::operator!=(const BigInt& comp) const
+{
+	return !(*this == comp);
+}
+
+bool BigInt::operator>=(const BigInt& comp) const
+{
+	if(this->isNegative ^ comp.isNegative)
+	{
+		// comp.isNegative == true --> "this" is positive.
+		return comp.isNegative;
+	}
+	else if(this->numLen != comp.numLen)
+	{
+		// Both negative -> if "this" is "shorter". Otherwise, reverse.
+		return (this->isNegative ^ (this->numLen > comp.numLen));
+	}
+	else
+	{
+		return this->isNegative ^ limbWiseGreater(this->number, comp.number, this->numLen, !this->isNegative);
+	}
+}
+
+bool BigInt::operator<=(const BigInt& comp) const
+{
+	return (comp >= *this);
+}
+
+bool BigInt::operator>(const BigInt& comp) const
+{
+	if(this->isNegative ^ comp.isNegative)
+	{
+		// comp.isNegative == true --> "this" is positive.
+		return comp.isNegative;
+	}
+	else if(this->numLen != comp.numLen)
+	{
+		// Both positive -> if "this" is longer. Otherwise, reverse.
+		return (this->isNegative ^ (this->numLen > comp.numLen));
+	}
+	else
+	{
+		return this->isNegative ^ limbWiseGreater(this->number, comp.number, this->numLen, this->isNegative);
+	}
+}
+
+bool BigInt::operator<(const BigInt& comp) const
+{
+	return (comp > *this);
+}
+
+BigInt BigInt::operator<<(const int offset) const
+{
+	if(offset <= 0 || this->numLen == 0)
+	{
+		return *this;
+	}
+	
+	int newLen;
+	limb_t *retVal = shiftBits(offset, this->number, this->numLen, newLen);
+	
+	return BigInt(retVal, this->isNegative, newLen, nullptr);
+}
+
+BigInt BigInt::operator>>(const int offset) const
 {
 	if(offset <= 0 || this->numLen == 0)
 	{
 		return *this;
 	}
 	
-	int newLen;
-	unsigned char *retVal = shiftBits(offset, this->number, this->numLen, newLen);
-	
-	return BigInt(retVal, this->isNegative, newLen, nullptr);
+	int newLen;
+	limb_t *retVal = shiftBits(-offset, this->number, this->numLen, newLen);
+	
+	return BigInt(retVal, this->isNegative, newLen, nullptr);
+}
+
+BigInt BigInt::square() const
+{
+	if(this->numLen == 0)
+	{
+		return BigInt(); // ZERO
+	}
+	
+	// Passing the same limb array twice lets the multiplication take its squaring paths.
+	int newLen;
+	limb_t* retVal = multiplicationUtil(this->number, this->numLen, this->number, this->numLen, newLen);
+	
+	return BigInt(retVal, false, newLen, nullptr);
+}
+
+BigInt BigInt::modPow(const BigInt& exp, const BigInt& mod) const
+{
+	if(mod.numLen == 1 && mod.number[0] == 1)
+	{
+		return BigInt(); // Everything is 0 modulo 1.
+	}
+	if(mod.numLen > 0 && (mod.number[0] & 1))
+	{
+		BigIntMontgomery context(mod);
+		return context.fromMontgomery(context.pow(context.toMontgomery(*this), exp));
+	}
+	
+	// Even moduli are left to square-and-multiply with a division for each step.
+	BigInt base = *this % mod;
+	if(base.isNegative)
+	{
+		base += mod;
+	}
+	BigInt ret(1);
+	int bits = (exp.numLen > 0) ? (exp.numLen * LIMB_BITS - countLeadingZeros(exp.number[exp.numLen - 1])) : 0;
+	for(int bit = bits - 1 ; bit >= 0 ; bit--)
+	{
+		ret = ret.square() % mod;
+		if(limbBit(exp.number, bit))
+		{
+			ret *= base;
+			ret %= mod;
+		}
+	}
+	return ret;
+}
+
+// Shifts a double limb held as (hi, lo) right by <bits>, which is less than 128.
+static inline void shiftPairRight(limb_t& hi, limb_t& lo, int bits)
+{
+	if(bits >= LIMB_BITS)
+	{
+		lo = hi >> (bits - LIMB_BITS);
+		hi = 0;
+	}
+	else if(bits > 0)
+	{
+		lo = (lo >> bits) | (hi << (LIMB_BITS - bits));
+		hi >>= bits;
+	}
+}
+
+// Number of the trailing zero bits of a non-zero double limb held as (hi, lo).
+static inline int pairTrailingZeros(limb_t hi, limb_t lo)
+{
+	return (lo != 0) ? countTrailingZeros(lo) : LIMB_BITS + countTrailingZeros(hi);
+}
+
+// The GCD of two values of up to two limbs, held as (hi, lo) pairs, by the binary method which only
+//  shifts and subtracts. The GCD is stored into <a>.
+static void binaryGcd(limb_t& aHi, limb_t& aLo, limb_t bHi, limb_t bLo)
+{
+	if((bHi | bLo) == 0)
+	{
+		return;
+	}
+	if((aHi | aLo) == 0)
+	{
+		aHi = bHi;
+		aLo = bLo;
+		return;
+	}
+	
+	int shift = pairTrailingZeros(aHi | bHi, aLo | bLo);
+	shiftPairRight(aHi, aLo, pairTrailingZeros(aHi, aLo));
+	while((bHi | bLo) != 0)
+	{
+		shiftPairRight(bHi, bLo, pairTrailingZeros(bHi, bLo));
+		if(aHi > bHi || (aHi == bHi && aLo > bLo))
+		{
+			limb_t swap = aHi;
+			aHi = bHi;
+			bHi = swap;
+			swap = aLo;
+			aLo = bLo;
+			bLo = swap;
+		}
+		limb_t borrow = (bLo < aLo) ? 1 : 0;
+		bLo -= aLo;
+		bHi -= aHi + borrow;
+	}
+	
+	// The GCD is less than both values, so shifting it back never overflows.
+	if(shift >= LIMB_BITS)
+	{
+		aHi = aLo << (shift - LIMB_BITS);
+		aLo = 0;
+	}
+	else if(shift > 0)
+	{
+		aHi = (aHi << shift) | (aLo >> (LIMB_BITS - shift));
+		aLo <<= shift;
+	}
+}
+
+// 64 bits of a limb array from a bit on, with zeros beyond it's end.
+static inline limb_t bitWindow(const limb_t* num, int len, int bit)
+{
+	int index = bit / LIMB_BITS;
+	int offset = bit % LIMB_BITS;
+	limb_t low = (index < len) ? num[index] : 0;
+	limb_t high = (index + 1 < len) ? num[index + 1] : 0;
+	return offset ? ((low >> offset) | (high << (LIMB_BITS - offset))) : low;
+}
+
+// Swaps two BigInts by moving them, without copying their limbs.
+static inline void swapValues(BigInt& x, BigInt& y)
+{
+	BigInt swap(static_cast<BigInt&&>(x));
+	x = static_cast<BigInt&&>(y);
+	y = static_cast<BigInt&&>(swap);
+}
+
+int BigInt::lehmerMatrixUtil(const BigInt& a, const BigInt& b, limb_t* matrix)
+{
+	// The leading 60 bits of <a>, and the bits of <b> at the same place. With them, the cofactors stay
+	//  below 2^30 and nothing below overflows.
+	int bits = a.numLen * LIMB_BITS - countLeadingZeros(a.number[a.numLen - 1]);
+	int shift = (bits > 60) ? bits - 60 : 0;
+	long long x = (long long)bitWindow(a.number, a.numLen, shift);
+	long long y = (long long)bitWindow(b.number, b.numLen, shift);
+	
+	long long A = 1;
+	long long B = 0;
+	long long C = 0;
+	long long D = 1;
+	int steps = 0;
+	while(y != C)
+	{
+		long long q = (x + (A - 1)) / (y - C);
+		long long s = B + q * D;
+		long long t = x - q * y;
+		if(s > t)
+		{
+			break;
+		}
+		x = y;
+		y = t;
+		t = A + q * C;
+		A = D;
+		B = C;
+		C = s;
+		D = t;
+		steps++;
+	}
+	
+	matrix[0] = (limb_t)A;
+	matrix[1] = (limb_t)B;
+	matrix[2] = (limb_t)C;
+	matrix[3] = (limb_t)D;
+	return steps;
+}
+
+void BigInt::lehmerApplyUtil(BigInt& x, BigInt& y, const limb_t* matrix, int steps, BigInt& t, BigInt& u)
+{
+	const BigInt& first = (steps & 1) ? y : x;
+	const BigInt& second = (steps & 1) ? x : y;
+	
+	t.setZero();
+	t.addmul(first, (long long)matrix[0]);
+	t.submul(second, (long long)matrix[1]);
+	u.setZero();
+	u.addmul(second, (long long)matrix[3]);
+	u.submul(first, (long long)matrix[2]);
+	
+	// The old values are kept in the scratch ones, so that their space is used again by the next step.
+	swapValues(x, t);
+	swapValues(y, u);
+}
+
+void BigInt::euclidStepUtil(BigInt& a, BigInt& b, BigInt* pairs, int pairCount)
+{
+	BigInt q;
+	a.divmod(b, q, a);
+	swapValues(a, b);
+	for(int i = 0 ; i < pairCount ; i++)
+	{
+		pairs[2 * i].submul(pairs[2 * i + 1], q);
+		swapValues(pairs[2 * i], pairs[2 * i + 1]);
+	}
+}
+
+bool BigInt::matrixApplyUtil(BigInt& a, BigInt& b, BigInt* n)
+{
+	BigInt first = n[0] * a;
+	first.addmul(n[2], b);
+	BigInt second = n[1] * a;
+	second.addmul(n[3], b);
+	
+	// A matrix from the upper part of the values MAY be off by the last few steps, which makes a result
+	//  negative or swaps them. One which doesn't reduce the values at all is dropped.
+	if(!a.absGreater(first) || !a.absGreater(second))
+	{
+		return false;
+	}
+	if(first.isNegative)
+	{
+		first.isNegative = false;
+		n[0] = -n[0];
+		n[2] = -n[2];
+	}
+	if(second.isNegative)
+	{
+		second.isNegative = false;
+		n[1] = -n[1];
+		n[3] = -n[3];
+	}
+	if(second.absGreater(first))
+	{
+		swapValues(first, second);
+		swapValues(n[0], n[1]);
+		swapValues(n[2], n[3]);
+	}
+	
+	swapValues(a, first);
+	swapValues(b, second);
+	return true;
+}
+
+void BigInt::halfGcdUtil(BigInt& a, BigInt& b, BigInt* n)
+{
+	n[0] = 1;
+	n[1] = 0;
+	n[2] = 0;
+	n[3] = 1;
+	int target = a.numLen / 2 + 1;
+	
+	if(a.numLen < HALF_GCD_THRESHOLD)
+	{
+		limb_t matrix[4];
+		BigInt t, u;
+		while(b.numLen > target)
+		{
+			int steps = lehmerMatrixUtil(a, b, matrix);
+			if(steps == 0)
+			{
+				euclidStepUtil(a, b, n, 2);
+				continue;
+			}
+			lehmerApplyUtil(a, b, matrix, steps, t, u);
+			lehmerApplyUtil(n[0], n[1], matrix, steps, t, u);
+			lehmerApplyUtil(n[2], n[3], matrix, steps, t, u);
+		}
+		return;
+	}
+	
+	// The upper half reduced to a half of it's length takes the whole values to about 3/4 of theirs.
+	int shift = a.numLen / 2;
+	BigInt upperA = a >> (shift * LIMB_BITS);
+	BigInt upperB = b >> (shift * LIMB_BITS);
+	BigInt sub[4];
+	halfGcdUtil(upperA, upperB, sub);
+	if(matrixApplyUtil(a, b, sub))
+	{
+		for(int i = 0 ; i < 4 ; i++)
+		{
+			swapValues(n[i], sub[i]);
+		}
+	}
+	if(b.numLen <= target)
+	{
+		return;
+	}
+	
+	// One whole step makes sure that the values get shorter, and the upper part of what's left is taken
+	//  so that reducing it to a half of it's length brings the values to the target.
+	euclidStepUtil(a, b, n, 2);
+	if(b.numLen <= target)
+	{
+		return;
+	}
+	shift = 2 * target - a.numLen;
+	if(shift < 0)
+	{
+		shift = 0;
+	}
+	upperA = a >> (shift * LIMB_BITS);
+	upperB = b >> (shift * LIMB_BITS);
+	halfGcdUtil(upperA, upperB, sub);
+	if(matrixApplyUtil(a, b, sub))
+	{
+		BigInt product[4];
+		product[0] = sub[0] * n[0];
+		product[0].addmul(sub[2], n[1]);
+		product[1] = sub[1] * n[0];
+		product[1].addmul(sub[3], n[1]);
+		product[2] = sub[0] * n[2];
+		product[2].addmul(sub[2], n[3]);
+		product[3] = sub[1] * n[2];
+		product[3].addmul(sub[3], n[3]);
+		for(int i = 0 ; i < 4 ; i++)
+		{
+			swapValues(n[i], product[i]);
+		}
+	}
+}
+
+void BigInt::gcdUtil(BigInt& a, BigInt& b, BigInt* cofactors)
+{
+	int pairCount = (cofactors != nullptr) ? 1 : 0;
+	limb_t matrix[4];
+	BigInt t, u;
+	while(b.numLen > 0)
+	{
+		if(cofactors == nullptr && a.numLen <= 2)
+		{
+			// The inline space may be a single limb, so the high limbs are only read if they're in use.
+			limb_t hi = (a.numLen > 1) ? a.number[1] : 0;
+			limb_t lo = a.number[0];
+			binaryGcd(hi, lo, (b.numLen > 1) ? b.number[1] : 0, b.number[0]);
+			a.growLimbs(2);
+			a.setZero();
+			a.number[0] = lo;
+			a.number[1] = hi;
+			a.numLen = trimmedLen(a.number, 2);
+			b.setZero();
+			return;
+		}
+		
+		if(a.numLen >= HALF_GCD_THRESHOLD && b.numLen > a.numLen / 2 + 1)
+		{
+			BigInt n[4];
+			halfGcdUtil(a, b, n);
+			if(cofactors != nullptr)
+			{
+				BigInt first = n[0] * cofactors[0];
+				first.addmul(n[2], cofactors[1]);
+				BigInt second = n[1] * cofactors[0];
+				second.addmul(n[3], cofactors[1]);
+				swapValues(cofactors[0], first);
+				swapValues(cofactors[1], second);
+			}
+			continue;
+		}
+		
+		// A value much shorter than the other leaves nothing in the leading bits, which takes a whole step.
+		int steps = lehmerMatrixUtil(a, b, matrix);
+		if(steps == 0)
+		{
+			euclidStepUtil(a, b, cofactors, pairCount);
+			continue;
+		}
+		lehmerApplyUtil(a, b, matrix, steps, t, u);
+		if(cofactors != nullptr)
+		{
+			lehmerApplyUtil(cofactors[0], cofactors[1], matrix, steps, t, u);
+		}
+	}
+}
+
+BigInt BigInt::gcd(const BigInt& other) const
+{
+	BigInt a = this->abs();
+	BigInt b = other.abs();
+	if(b.absGreater(a))
+	{
+		swapValues(a, b);
+	}
+	if(a.numLen > 0)
+	{
+		gcdUtil(a, b, nullptr);
+	}
+	return a;
+}
+
+BigInt BigInt::extendedGcd(const BigInt& other, BigInt& x, BigInt& y) const
+{
+	bool thisNeg = this->isNegative;
+	bool otherNeg = other.isNegative;
+	BigInt larger = this->abs();
+	BigInt smaller = other.abs();
+	bool swapped = smaller.absGreater(larger);
+	if(swapped)
+	{
+		swapValues(larger, smaller);
+	}
+	
+	BigInt g = larger;
+	BigInt coefLarger(1);
+	BigInt coefSmaller;
+	if(smaller.numLen > 0)
+	{
+		BigInt b = smaller;
+		BigInt cofactors[2] = {BigInt(1), BigInt()};
+		gcdUtil(g, b, cofactors);
+		
+		// The coefficient is moved into [0, smaller / g), and the other one follows from it.
+		BigInt q, bound;
+		smaller.divmod(g, bound, q);
+		cofactors[0].floorDivmod(bound, q, coefLarger);
+		coefSmaller = g;
+		coefSmaller.submul(larger, coefLarger);
+		coefSmaller.divmod(smaller, coefSmaller, q);
+	}
+	else if(larger.numLen == 0)
+	{
+		coefLarger = 0;
+	}
+	
+	if(swapped)
+	{
+		swapValues(coefLarger, coefSmaller);
+	}
+	if(thisNeg)
+	{
+		coefLarger = -coefLarger;
+	}
+	if(otherNeg)
+	{
+		coefSmaller = -coefSmaller;
+	}
+	swapValues(x, coefLarger);
+	swapValues(y, coefSmaller);
+	return g;
+}
+
+BigInt BigInt::modInverse(const BigInt& mod) const
+{
+	// The pair {0, 1} follows the coefficient of the second value, which is this one reduced.
+	BigInt q;
+	BigInt a = mod;
+	BigInt b;
+	this->floorDivmod(mod, q, b);
+	BigInt cofactors[2] = {BigInt(), BigInt(1)};
+	gcdUtil(a, b, cofactors);
+	if(!(a == 1))
+	{
+		return BigInt();
+	}
+	
+	BigInt ret;
+	cofactors[0].floorDivmod(mod, q, ret);
+	return ret;
+}
+
+// Integer square root implemented in binary format.
+//  It's similar to manual-sqrt. taughted in the school,
+//  but in binary. :)
+BigInt BigInt::sqrt(bool ignoreNegative) const
+{
+	if((!ignoreNegative && this->isNegative) || this->numLen == 0)
+	{
+		// lol sqrt(-1)?
+		return BigInt();
+	}
+	
+	if(this->numLen >= SQRT_NEWTON_THRESHOLD)
+	{
+		return rootUtil(this->abs(), 2);
+	}
+	
+	int len = this->numLen + 1;
+	
+	// What is left of the value after the root found so far is taken away.
+	ScratchLimbs remain(len);
+	memcpy(remain, this->number, this->numLen * sizeof(limb_t));
+	remain[this->numLen] = 0;
+	
+	// The root found so far, scaled by the chunks which are not processed yet.
+	limb_t* root = allocZerosMem(len);
+	
+	ScratchLimbs trial(len);
+	
+	// Each "chunk" contains two bits, just like manual-sqrt. grouping the digits by 2.
+	//  The chunks are walked from the leading one, which holds the highest set bit.
+	int bit = (this->numLen * LIMB_BITS - 1 - countLeadingZeros(this->number[this->numLen - 1])) & ~1;
+	
+	for( ; bit >= 0 ; bit -= 2)
+	{
+		// trial = root + (1 << bit)
+		memcpy(trial, root, len * sizeof(limb_t));
+		limb_t bitVal = 1ULL << (bit % LIMB_BITS);
+		limbWiseAdditionNoCopy(trial + bit / LIMB_BITS, len - bit / LIMB_BITS, &bitVal, 1, trial + bit / LIMB_BITS, len - bit / LIMB_BITS);
+		
+		bool taken = limbWiseGreater(remain, trial, len, true);
+		if(taken)
+		{
+			// remain -= trial, root += (2 << bit)
+			limbWiseNegationNoCopy(remain, len, trial, len, remain, len);
+			bitVal = 1ULL << ((bit + 1) % LIMB_BITS);
+			limbWiseAdditionNoCopy(root + (bit + 1) / LIMB_BITS, len - (bit + 1) / LIMB_BITS, &bitVal, 1, root + (bit + 1) / LIMB_BITS, len - (bit + 1) / LIMB_BITS);
+		}
+		
+		// root >>= 1
+		for(int i = 0 ; i < len - 1 ; i++)
+		{
+			root[i] = (root[i] >> 1) | (root[i + 1] << (LIMB_BITS - 1));
+		}
+		root[len - 1] >>= 1;
+	}
+	
+	return BigInt(root, false, len, nullptr);
+}
+
+// base ^ exp, for a non-negative <exp>.
+static BigInt powPlain(const BigInt& base, int exp)
+{
+	BigInt ret(1);
+	BigInt power = base;
+	while(exp > 0)
+	{
+		if(exp & 1)
+		{
+			ret *= power;
+		}
+		exp >>= 1;
+		if(exp > 0)
+		{
+			power = power.square();
+		}
+	}
+	return ret;
+}
+
+BigInt BigInt::rootUtil(const BigInt& n, int k)
+{
+	int bits = n.numLen * LIMB_BITS - countLeadingZeros(n.number[n.numLen - 1]);
+	int rootBits = (bits + k - 1) / k;
+	
+	// A short root is found bit by bit from the top.
+	if(rootBits <= LIMB_BITS / 2)
+	{
+		BigInt ret;
+		for(int bit = rootBits - 1 ; bit >= 0 ; bit--)
+		{
+			BigInt trial = ret + (BigInt(1) << bit);
+			if(!(powPlain(trial, k) > n))
+			{
+				ret = trial;
+			}
+		}
+		return ret;
+	}
+	
+	// The root of the upper (bits - k * h) bits, shifted back by h bits and rounded up, is above the root
+	//  by less than 2^(h + 1). One step squares the error (times about (k - 1) / (2 * root)), which leaves
+	//  it below 1 with h taken as below.
+	int kBits = 0;
+	while(kBits < 30 && (1 << kBits) < k)
+	{
+		kBits++;
+	}
+	int h = (rootBits - kBits - 4) / 2;
+	BigInt x;
+	if(h < 1)
+	{
+		x = BigInt(1) << rootBits;
+	}
+	else
+	{
+		BigInt top = n >> (k * h);
+		BigInt upper = (k == 2) ? top.sqrt() : rootUtil(top, k);
+		x = (upper + 1) << h;
+	}
+	
+	// Every step stays at or above the root, so a step whose k-th power is not above <n> hits it.
+	while(true)
+	{
+		BigInt next;
+		if(k == 2)
+		{
+			next = (x + n / x) >> 1;
+			if(!(next.square() > n))
+			{
+				return next;
+			}
+		}
+		else
+		{
+			next = (x * (k - 1) + n / powPlain(x, k - 1)) / k;
+			if(!(powPlain(next, k) > n))
+			{
+				return next;
+			}
+		}
+		x = next;
+	}
+}
+
+BigInt BigInt::nthRoot(int k) const
+{
+	if(k < 1 || this->numLen == 0 || (this->isNegative && !(k & 1)))
+	{
+		return BigInt();
+	}
+	if(k == 1)
+	{
+		return *this;
+	}
+	
+	BigInt ret = (k == 2) ? this->sqrt() : rootUtil(this->abs(), k);
+	return this->isNegative ? -ret : ret;
+}
+
+// The odd primes below this are used for trial division and by BigIntPrimeSieve.
+#ifndef SMALL_PRIME_LIMIT
+#define SMALL_PRIME_LIMIT 65536
+#endif
+
+// A bound of the number of the odd primes below SMALL_PRIME_LIMIT, which holds from 2 up to far beyond it.
+#define SMALL_PRIME_MAX_COUNT (SMALL_PRIME_LIMIT / 8 + 64)
+
+// Number of the odd values in each segment of BigIntPrimeSieve.
+#ifndef PRIME_SIEVE_SEGMENT
+#define PRIME_SIEVE_SEGMENT 4096
+#endif
+
+// Roughly how many groups of the small primes are tried per limb of the value.
+#ifndef TRIAL_GROUPS_PER_LIMB
+#define TRIAL_GROUPS_PER_LIMB 16
+#endif
+
+// The odd primes, and their products grouped in order so that each fits into a limb. The primes of the
+//  group i are primes[groupStarts[i]] to primes[groupStarts[i + 1] - 1].
+struct SmallPrimeTable
+{
+	limb_t primes[SMALL_PRIME_MAX_COUNT];
+	int count;
+	limb_t groups[SMALL_PRIME_MAX_COUNT];
+	int groupStarts[SMALL_PRIME_MAX_COUNT + 1];
+	int groupCount;
+	
+	// Finds the odd primes below SMALL_PRIME_LIMIT by the sieve of Eratosthenes.
+	SmallPrimeTable()
+	{
+		bool* composite = new bool[SMALL_PRIME_LIMIT]();
+		count = 0;
+		for(int i = 3 ; i < SMALL_PRIME_LIMIT ; i += 2)
+		{
+			if(composite[i])
+			{
+				continue;
+			}
+			primes[count++] = i;
+			for(int j = (i < SMALL_PRIME_LIMIT / i) ? i * i : SMALL_PRIME_LIMIT ; j < SMALL_PRIME_LIMIT ; j += 2 * i)
+			{
+				composite[j] = true;
+			}
+		}
+		delete [] composite;
+		
+		groupCount = 0;
+		for(int i = 0 ; i < count ; i++)
+		{
+			limb_t p = primes[i];
+			if(i == 0 || groups[groupCount - 1] > ~(limb_t)0 / p)
+			{
+				groupStarts[groupCount] = i;
+				groups[groupCount++] = p;
+			}
+			else
+			{
+				groups[groupCount - 1] *= p;
+			}
+		}
+		groupStarts[groupCount] = count;
+	}
+};
+
+// The table is built in place on first use rather than by a static initializer, as it's too large for
+//  the stack of some threads.
+static const SmallPrimeTable& smallPrimes()
+{
+	static const SmallPrimeTable table;
+	return table;
+}
+
+bool BigInt::isPerfectPower(BigInt& base, int& exp) const
+{
+	const SmallPrimeTable& table = smallPrimes();
+	if(this->numLen == 0 || (this->numLen == 1 && this->number[0] == 1))
+	{
+		base = *this;
+		exp = this->isNegative ? 3 : 2;
+		return true;
+	}
+	
+	BigInt n = this->abs();
+	int bits = n.numLen * LIMB_BITS - countLeadingZeros(n.number[n.numLen - 1]);
+	
+	// The exponent of 2 in b^e is a multiple of e.
+	int zeros = 0;
+	while(!limbBit(n.number, zeros))
+	{
+		zeros++;
+	}
+	
+	// Only the prime exponents are tried, from the smallest one. The exponents beyond the table of the
+	//  small primes (for values of so many bits) are all tried.
+	for(int i = this->isNegative ? 0 : -1 ; ; i++)
+	{
+		int e;
+		if(i < 0)
+		{
+			e = 2;
+		}
+		else if(i < table.count)
+		{
+			e = (int)table.primes[i];
+		}
+		else
+		{
+			e = SMALL_PRIME_LIMIT + 1 + 2 * (i - table.count);
+		}
+		if(e >= bits)
+		{
+			return false;
+		}
+		if(zeros > 0 && zeros % e != 0)
+		{
+			continue;
+		}
+		
+		BigInt root = rootUtil(n, e);
+		if(powPlain(root, e) == n)
+		{
+			// The root MAY be a perfect power itself, which makes the exponent larger.
+			if(this->isNegative)
+			{
+				root = -root;
+			}
+			int rootExp;
+			if(root.isPerfectPower(base, rootExp))
+			{
+				exp = e * rootExp;
+			}
+			else
+			{
+				base = root;
+				exp = e;
+			}
+			return true;
+		}
+	}
 }
 
-const BigInt BigInt::operator>>(const int offset) const
+bool BigInt::isPerfectPower() const
 {
-	if(offset <= 0 || this->numLen == 0)
+	BigInt base;
+	int exp;
+	return this->isPerfectPower(base, exp);
+}
+
+// The Jacobi symbol (a / n) of an odd <n>.
+static int jacobiSymbol(limb_t a, limb_t n)
+{
+	int ret = 1;
+	a %= n;
+	while(a != 0)
 	{
-		return *this;
+		while(!(a & 1))
+		{
+			a >>= 1;
+			if((n & 7) == 3 || (n & 7) == 5)
+			{
+				ret = -ret;
+			}
+		}
+		limb_t swap = a;
+		a = n;
+		n = swap;
+		if((a & 3) == 3 && (n & 3) == 3)
+		{
+			ret = -ret;
+		}
+		a %= n;
 	}
-	
-	int newLen;
-	unsigned char *retVal = shiftBits(-offset, this->number, this->numLen, newLen);
-	
-	return BigInt(retVal, this->isNegative, newLen, nullptr);
+	return (n == 1) ? ret : 0;
 }
 
-const BigInt BigInt::square() const
+// (x + y) mod m, for <x> and <y> in [0, m).
+static inline void addModInPlace(BigInt& x, const BigInt& y, const BigInt& m)
 {
-	return *this * *this;
+	x += y;
+	if(x >= m)
+	{
+		x -= m;
+	}
 }
 
-// Integer square root implemented in binary format.
-//  It's similar to manual-sqrt. taughted in the school,
-//  but in binary. :)
-const BigInt BigInt::sqrt(bool ignoreNegative) const
+// (x - y) mod m, for <x> and <y> in [0, m).
+static inline void subModInPlace(BigInt& x, const BigInt& y, const BigInt& m)
 {
-	if(!ignoreNegative && this->isNegative)
+	if(x < y)
 	{
-		// lol sqrt(-1)?
-		return BigInt();
+		x += m;
 	}
-	
-	unsigned char* copy = new unsigned char[this->numLen + 1];
-	copy[this->numLen] = 0;
-	memcpy(copy, this->number, this->numLen);
-	
-	// Each "chunk" contains two bits, just like manual-sqrt. grouping the digits by 2.
-	//  Thus, each byte is seperated into 4 chunks.
-	int leadingSqrtBit;
-	char c;
-	for(leadingSqrtBit = 3 ; leadingSqrtBit > 0 ; leadingSqrtBit--)
+	x -= y;
+}
+
+// (x / 2) mod m, for <x> in [0, m) and an odd <m>.
+static inline void halveModInPlace(BigInt& x, const BigInt& m)
+{
+	if(x.getRawBytes()[0] & 1)
+	{
+		x += m;
+	}
+	x = x >> 1;
+}
+
+bool BigInt::primeLimbUtil(limb_t n)
+{
+	const SmallPrimeTable& table = smallPrimes();
+	if(n < 2)
+	{
+		return false;
+	}
+	if(!(n & 1))
 	{
-		if(copy[this->numLen - 1] >= (c = (1 << (2 * leadingSqrtBit))))
+		return n == 2;
+	}
+	// Only the first primes are tried, as the Miller-Rabin test below is cheaper than going through all of them.
+	for(int i = 0 ; i < table.count && i < 64 ; i++)
+	{
+		limb_t p = table.primes[i];
+		if(p * p > n)
 		{
-			// Now the "leadingSqrtBit" is the bit wise 'index' of the leading byte.
-			break;
+			return true;
+		}
+		if(n % p == 0)
+		{
+			return false;
 		}
 	}
 	
-	int sqrtBinLen = (this->numLen - 1) * 4 + leadingSqrtBit;
-	int sqrtHexLen = (this->numLen + 1) / 2;
-	
-	unsigned char* sqrtCache = allocZerosMem(sqrtHexLen + 1);
-	
-	// Adding 2 is just for convience. Or runtime errors may sometimes occur. D:
-	unsigned char* multCache = new unsigned char[this->numLen + 2];
-	
-	unsigned char* retVal = allocZerosMem(sqrtHexLen);
-	
-	int byteIndex = sqrtBinLen / 8;
-	int bitOffset = sqrtBinLen % 8;
-	int cacheLen, cacheShift, retIterLen;
-	unsigned char byteVal;
+	// The first 12 primes as the bases tell every value below 318665857834031151167461 (about 3.2 * 10^23)
+	//  apart, which covers the limb.
+	static const limb_t BASES[12] = {2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37};
+	int s = 0;
+	limb_t d = n - 1;
+	while(!(d & 1))
+	{
+		d >>= 1;
+		s++;
+	}
+	for(int i = 0 ; i < 12 ; i++)
+	{
+		limb_t x = powModPlain(BASES[i], d, n);
+		if(x == 1 || x == n - 1)
+		{
+			continue;
+		}
+		int r = 1;
+		for( ; r < s ; r++)
+		{
+			x = mulModPlain(x, x, n);
+			if(x == n - 1)
+			{
+				break;
+			}
+		}
+		if(r == s)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+bool BigInt::trialDivisionUtil() const
+{
+	const SmallPrimeTable& table = smallPrimes();
+	// Most composites have a factor in the first group, which is tried alone before building the whole tree.
+	limb_t first = limbDivisionNoCopy(this->number, this->numLen, table.groups[0], nullptr);
+	for(int j = 0 ; j < table.groupStarts[1] ; j++)
+	{
+		if(first % table.primes[j] == 0)
+		{
+			return true;
+		}
+	}
 	
-	unsigned short cache = 0;
-	unsigned char* cPtr = castPtr<unsigned char>(&cache);
-	unsigned short space = 0;
+	// One remainder per group through the product tree, and then each prime of a group against it's remainder.
+	//  The tree is cut so that it has about TRIAL_GROUPS_PER_LIMB groups per limb of the value, as a further
+	//  prime is less likely to be a factor than the test that follows is to tell.
+	int level = 0;
+	int count;
+	while((1 << level) < TRIAL_GROUPS_PER_LIMB * this->numLen && primeTreeUtil(level + 1, count) != nullptr)
+	{
+		level++;
+	}
+	primeTreeUtil(0, count);
+	if(count > (1 << level))
+	{
+		count = 1 << level;
+	}
+	ScratchLimbs remainders(1 << level);
+	remainderTreeUtil(this->number, this->numLen, level, 0, remainders);
 	
-	while(byteIndex >= 0)
+	for(int i = 1 ; i < count ; i++)
 	{
-		while(bitOffset >= 0)
+		for(int j = table.groupStarts[i] ; j < table.groupStarts[i + 1] ; j++)
 		{
-			byteVal = 1 << bitOffset;
-		
-			sqrtCache[byteIndex] += byteVal;
-		
-			cache = 0;
-			for(int j = byteIndex ; j <= sqrtHexLen + 1 ; j++)
+			if(remainders[i] % table.primes[j] == 0)
 			{
-				space = sqrtCache[j];
-				cache += space * byteVal;
-				multCache[byteIndex + j] = *cPtr;
-				cache >>= 8;
+				return true;
 			}
+		}
+	}
+	return false;
+}
+
+// The levels of the product tree of the small prime groups, from the groups up to a single node. Each thread
+//  has it's own, which is built on the first use.
+struct PrimeTreeCache
+{
+	limb_t* levels[32];
+	int counts[32];
+	int count;
+	
+	~PrimeTreeCache()
+	{
+		for(int i = 0 ; i < count ; i++)
+		{
+			delete [] levels[i];
+		}
+	}
+};
+
+static thread_local PrimeTreeCache primeTreeCache;
+
+const limb_t* BigInt::primeTreeUtil(int level, int& count)
+{
+	const SmallPrimeTable& table = smallPrimes();
+	PrimeTreeCache& cache = primeTreeCache;
+	if(cache.count == 0)
+	{
+		// The cache outlives any allocator, so it's kept away from them.
+		cache.levels[0] = new limb_t[table.groupCount];
+		memcpy(cache.levels[0], table.groups, table.groupCount * sizeof(limb_t));
+		cache.counts[0] = table.groupCount;
+		cache.count = 1;
+		
+		while(cache.counts[cache.count - 1] > 1)
+		{
+			const limb_t* below = cache.levels[cache.count - 1];
+			int belowCount = cache.counts[cache.count - 1];
+			int stride = 1 << (cache.count - 1);
+			int nodeCount = (belowCount + 1) / 2;
 			
-			cacheLen = this->numLen - 2 * byteIndex;
-			cacheShift = 2 * byteIndex;
-			if(byteWiseGreater(copy + cacheShift, multCache + cacheShift, cacheLen, true))
+			limb_t* nodes = new limb_t[nodeCount * 2 * stride];
+			memset(nodes, 0, nodeCount * 2 * stride * sizeof(limb_t));
+			for(int j = 0 ; j < nodeCount ; j++)
 			{
-				byteWiseNegationNoCopy(copy + cacheShift, cacheLen, multCache + cacheShift, cacheLen, copy + cacheShift, cacheLen);
-				byteWiseAdditionNoCopy(sqrtCache + byteIndex, 2, &byteVal, 1, sqrtCache + byteIndex, 2);
-				retVal[byteIndex] += byteVal;
-			}
-			else
-			{
-				sqrtCache[byteIndex] -= byteVal;
+				const limb_t* left = below + 2 * j * stride;
+				if(2 * j + 1 < belowCount)
+				{
+					const limb_t* right = left + stride;
+					multiplicationNoCopy(left, trimmedLen(left, stride), right, trimmedLen(right, stride), nodes + 2 * j * stride);
+				}
+				else
+				{
+					memcpy(nodes + 2 * j * stride, left, stride * sizeof(limb_t));
+				}
 			}
 			
-			bitOffset--;
+			cache.levels[cache.count] = nodes;
+			cache.counts[cache.count] = nodeCount;
+			cache.count++;
 		}
-		byteIndex--;
-		bitOffset += 8;
 	}
 	
-	delete [] copy;
-	delete [] sqrtCache;
-	delete [] multCache;
+	if(level >= cache.count)
+	{
+		return nullptr;
+	}
+	count = cache.counts[level];
+	return cache.levels[level];
+}
+
+void BigInt::remainderTreeUtil(const limb_t* num, int len, int level, int index, limb_t* remainders)
+{
+	int count;
+	const limb_t* nodes = primeTreeUtil(level, count);
+	if(index >= count)
+	{
+		return;
+	}
+	
+	if(level == 0)
+	{
+		remainders[index] = limbDivisionNoCopy(num, len, nodes[index], nullptr);
+		return;
+	}
+	
+	const limb_t* node = nodes + ((limb_t)index << level);
+	int nodeLen = trimmedLen(node, 1 << level);
+	if(len < nodeLen)
+	{
+		// Already less than the node, and so than any node under it except the groups.
+		remainderTreeUtil(num, len, level - 1, 2 * index, remainders);
+		remainderTreeUtil(num, len, level - 1, 2 * index + 1, remainders);
+		return;
+	}
+	
+	int qLen = len - nodeLen + 1;
+	ScratchLimbs quotient(qLen);
+	ScratchLimbs remain(len + 1);
+	memcpy(remain, num, len * sizeof(limb_t));
+	remain[len] = 0;
+	divisionUtil(node, nodeLen, quotient, qLen, remain);
 	
-	return BigInt(retVal, false, sqrtHexLen, nullptr);
+	int remainLen = trimmedLen(remain, nodeLen);
+	remainderTreeUtil(remain, remainLen, level - 1, 2 * index, remainders);
+	remainderTreeUtil(remain, remainLen, level - 1, 2 * index + 1, remainders);
 }
 
-bool BigInt::isPrime() const
+bool BigInt::millerRabinUtil(const BigIntMontgomery& context, const BigInt& base)
 {
-	static const unsigned char* TWO = new unsigned char(2);
+	// n - 1 = d * 2^s with an odd d.
+	const BigInt& n = context.getModulus();
+	BigInt nMinus1 = n - 1;
+	int s = 0;
+	while(!limbBit(nMinus1.number, s))
+	{
+		s++;
+	}
 	
-	if(this->numLen == 0)
+	// Both 1 and -1 are compared in Montgomery form.
+	BigInt one = context.toMontgomery(BigInt(1));
+	BigInt minusOne = n - one;
+	BigInt x = context.pow(context.toMontgomery(base), nMinus1 >> s);
+	if(x == one || x == minusOne)
 	{
-		return false;
+		return true;
 	}
-	else if(this->numLen == 1)
+	for(int r = 1 ; r < s ; r++)
 	{
-		if(this->number[0] == 1)
+		x = context.sqr(x);
+		if(x == minusOne)
+		{
+			return true;
+		}
+		if(x == one)
 		{
 			return false;
 		}
-		else if(this->number[0] == 2)
+	}
+	return false;
+}
+
+bool BigInt::lucasUtil(const BigIntMontgomery& context)
+{
+	const BigInt& n = context.getModulus();
+	
+	// The Jacobi symbol (D / n) comes from (n mod |D| / |D|) by the reciprocity, and (-1 / n) for a negative D.
+	//  There's no such D for a perfect square, so it's checked for if the first few don't make it.
+	long long d = 5;
+	for(int tries = 1 ; ; tries++)
+	{
+		limb_t absD = (d < 0) ? -d : d;
+		int jacobi = jacobiSymbol(limbDivisionNoCopy(n.number, n.numLen, absD, nullptr), absD);
+		if(((absD - 1) / 2) & ((n.number[0] - 1) / 2) & 1)
+		{
+			jacobi = -jacobi;
+		}
+		if(d < 0 && (n.number[0] & 3) == 3)
+		{
+			jacobi = -jacobi;
+		}
+		
+		if(jacobi == -1)
+		{
+			break;
+		}
+		if(jacobi == 0)
+		{
+			return false; // |D| shares a factor with n, which is longer than it.
+		}
+		if(tries == 8)
+		{
+			BigInt root = n.sqrt();
+			if(root.square() == n)
+			{
+				return false;
+			}
+		}
+		d = (d > 0) ? -(d + 2) : -(d - 2);
+	}
+	
+	// n + 1 = k * 2^s with an odd k. U(k) and V(k) are computed by walking the bits of k from the top, with
+	//  U(2j) = U(j) * V(j), V(2j) = V(j)^2 - 2Q^j, U(j + 1) = (U(j) + V(j)) / 2 and V(j + 1) = (D * U(j) + V(j)) / 2.
+	BigInt nPlus1 = n + 1;
+	int s = 0;
+	while(!limbBit(nPlus1.number, s))
+	{
+		s++;
+	}
+	BigInt k = nPlus1 >> s;
+	
+	BigInt one = context.toMontgomery(BigInt(1));
+	BigInt dMont = context.toMontgomery(BigInt((int)d));
+	BigInt qMont = context.toMontgomery(BigInt((int)((1 - d) / 4)));
+	BigInt u = one;
+	BigInt v = one;
+	BigInt qk = qMont;
+	int bits = k.numLen * LIMB_BITS - countLeadingZeros(k.number[k.numLen - 1]);
+	for(int bit = bits - 2 ; bit >= 0 ; bit--)
+	{
+		u = context.mul(u, v);
+		v = context.sqr(v);
+		subModInPlace(v, qk, n);
+		subModInPlace(v, qk, n);
+		qk = context.sqr(qk);
+		if(limbBit(k.number, bit))
+		{
+			BigInt du = context.mul(dMont, u);
+			addModInPlace(u, v, n);
+			halveModInPlace(u, n);
+			addModInPlace(v, du, n);
+			halveModInPlace(v, n);
+			qk = context.mul(qk, qMont);
+		}
+	}
+	
+	// Strong test: U(k) == 0, or V(k * 2^r) == 0 for some r < s.
+	if(u.numLen == 0 || v.numLen == 0)
+	{
+		return true;
+	}
+	for(int r = 1 ; r < s ; r++)
+	{
+		v = context.sqr(v);
+		subModInPlace(v, qk, n);
+		subModInPlace(v, qk, n);
+		if(v.numLen == 0)
 		{
 			return true;
 		}
+		qk = context.sqr(qk);
+	}
+	return false;
+}
+
+bool BigInt::isPrime() const
+{
+	if(this->numLen <= 1)
+	{
+		return primeLimbUtil(this->number[0]);
+	}
+	if(!(this->number[0] & 1) || this->trialDivisionUtil())
+	{
+		return false;
 	}
 	
-	if(this->number[0] % 2 == 0)
+	BigIntMontgomery context(*this);
+	return millerRabinUtil(context, BigInt(2)) && lucasUtil(context);
+}
+
+bool BigInt::isProbablePrime(int rounds) const
+{
+	if(this->numLen <= 1)
+	{
+		return primeLimbUtil(this->number[0]);
+	}
+	if(!(this->number[0] & 1) || this->trialDivisionUtil())
 	{
 		return false;
 	}
 	
-	const BigInt bi = this->sqrt(true);
-	unsigned char* cache = allocZerosMem(bi.numLen + 1);
-	cache[0] = 3;
-	int cacheLen = 1;
-	int qLen = this->numLen - cacheLen + 1;
+	BigIntMontgomery context(*this);
+	const BigInt& n = context.getModulus();
+	BigInt range = n - 3;
 	
-	unsigned char* copy = new unsigned char[this->numLen + 1];
-	unsigned char* ignored = new unsigned char[this->numLen];
+	// Base 2 is always tested, even if no round is asked for.
+	if(rounds < 1)
+	{
+		rounds = 1;
+	}
 	
-	bool fullyDivided = false;
-	while(byteWiseGreater(bi.number, cache, bi.numLen, true))
+	// The bases after 2 are taken from a xorshift generator seeded with the value, so that a result can
+	//  be reproduced.
+	limb_t state = this->number[0] ^ ((limb_t)this->numLen << 32) ^ 0x9E3779B97F4A7C15ULL;
+	for(int round = 0 ; round < rounds ; round++)
 	{
-		copy[this->numLen] = 0;
-		memcpy(copy, this->number, this->numLen);
-		divisionUtil(cache, cacheLen, ignored, qLen, copy);
-		
-		fullyDivided = true;
-		for(int i = 0 ; i < cacheLen ; i++)
+		BigInt base(2);
+		if(round > 0)
 		{
-			if(copy[i] != 0)
+			BigInt random(this->numLen, nullptr);
+			for(int i = 0 ; i < this->numLen ; i++)
 			{
-				fullyDivided = false;
-				break;
+				state ^= state << 13;
+				state ^= state >> 7;
+				state ^= state << 17;
+				random.number[i] = state;
 			}
+			random.numLen = trimmedLen(random.number, this->numLen);
+			base = random % range + 2;
 		}
-		
-		if(fullyDivided)
-		{
-			break;
-		}
-		
-		byteWiseAdditionNoCopy(cache, cacheLen, TWO, 1, cache, cacheLen + 1);
-		if(cache[cacheLen] != 0)
+		if(!millerRabinUtil(context, base))
 		{
-			// carry!!;
-			cacheLen++;
-			qLen--;
+			return false;
 		}
 	}
-	
-	delete [] cache;
-	delete [] copy;
-	delete [] ignored;
-	
-	return !fullyDivided;
+	return true;
+}
+
+BigInt BigInt::nextPrime() const
+{
+	BigIntPrimeSieve sieve(*this + 1);
+	return sieve.next();
+}
+
+BigInt BigInt::prevPrime() const
+{
+	BigIntPrimeSieve sieve(*this - 1, true);
+	return sieve.next();
 }
 
 char* BigInt::getHexString() const
@@ -1048,15 +3842,19 @@ char* BigInt::getHexString() const
 	
 	static const char digits[] = "0123456789ABCDEF";
 	
-	const int retLen = this->numLen * 2 + (this->isNegative ? 1 : 0) + 1;
+	// The output is still grouped in bytes, so the leading zero bytes of the leading limb are skipped.
+	const unsigned char* bytes = this->getRawBytes();
+	const int bytesLen = this->numLen * sizeof(limb_t) - countLeadingZeros(this->number[this->numLen - 1]) / 8;
+	
+	const int retLen = bytesLen * 2 + (this->isNegative ? 1 : 0) + 1;
 	
 	char* ret = new char[retLen];
 	ret[retLen - 1] = 0;
 	
-	for(int i = 0 ; i < this->numLen ; i++)
+	for(int i = 0 ; i < bytesLen ; i++)
 	{
-		ret[retLen - 2 * i - 2] = digits[this->number[i] % 16];
-		ret[retLen - 2 * i - 3] = digits[this->number[i] / 16];
+		ret[retLen - 2 * i - 2] = digits[bytes[i] % 16];
+		ret[retLen - 2 * i - 3] = digits[bytes[i] / 16];
 	}
 	
 	if(this->isNegative)
@@ -1067,191 +3865,282 @@ char* BigInt::getHexString() const
 	return ret;
 }
 
-unsigned char** BigInt::CREATE_TENS()
+// 10^(19 * 2^level) for each level computed so far, which are kept across calls. Each thread has it's own.
+struct TenPowerCache
+{
+	limb_t* powers[32];
+	int lens[32];
+	int count;
+	
+	~TenPowerCache()
+	{
+		for(int i = 0 ; i < count ; i++)
+		{
+			delete [] powers[i];
+		}
+	}
+};
+
+static thread_local TenPowerCache tenPowerCache;
+
+const limb_t* BigInt::tenPowerUtil(int level, int& len)
+{
+	TenPowerCache& cache = tenPowerCache;
+	if(cache.count == 0)
+	{
+		cache.powers[0] = new limb_t[1];
+		cache.powers[0][0] = TEN_POW_19;
+		cache.lens[0] = 1;
+		cache.count = 1;
+	}
+	while(cache.count <= level)
+	{
+		const limb_t* last = cache.powers[cache.count - 1];
+		int lastLen = cache.lens[cache.count - 1];
+		// The cache outlives any allocator, so it's kept away from them.
+		cache.powers[cache.count] = new limb_t[2 * lastLen];
+		multiplicationNoCopy(last, lastLen, last, lastLen, cache.powers[cache.count]);
+		cache.lens[cache.count] = trimmedLen(cache.powers[cache.count], 2 * lastLen);
+		cache.count++;
+	}
+	len = cache.lens[level];
+	return cache.powers[level];
+}
+
+void BigInt::decimalStringUtil(const limb_t* num, int len, char* out, int outLen)
 {
-	unsigned char** ret = new unsigned char*[8];
-	static unsigned short* temp = nullptr;
-	for(int i = 0 ; i < 8 ; i++)
+	len = trimmedLen(num, len);
+	
+	if(len < DECIMAL_SPLIT_THRESHOLD || outLen <= TEN_POW_19_DIGITS)
 	{
-		ret[i] = new unsigned char[2];
+		ScratchLimbs cache(len + 1);
+		memcpy(cache, num, len * sizeof(limb_t));
 		
-		temp = castPtr<unsigned short>(ret[i]);
-		*temp = (10 << i);
+		// Each pass divides the whole value by 10^19 and gives 19 digits, from the tail.
+		for(int end = outLen ; end > 0 ; end -= TEN_POW_19_DIGITS)
+		{
+			limb_t chunk = 0;
+			if(len > 0)
+			{
+				chunk = limbDivisionNoCopy(cache, len, TEN_POW_19, cache);
+				len = trimmedLen(cache, len);
+			}
+			for(int i = 1 ; i <= TEN_POW_19_DIGITS ; i++)
+			{
+				out[end - i] = (chunk % 10) + '0';
+				chunk /= 10;
+			}
+		}
+		return;
 	}
 	
-	return ret;
+	// The upper half of the digits is the quotient by 10^half, and the lower half is the remainder.
+	int half = outLen / 2;
+	int level = 0;
+	while((TEN_POW_19_DIGITS << level) < half)
+	{
+		level++;
+	}
+	int powLen;
+	const limb_t* pow = tenPowerUtil(level, powLen);
+	
+	if(len < powLen)
+	{
+		memset(out, '0', half);
+		decimalStringUtil(num, len, out + half, half);
+		return;
+	}
+	
+	int qLen = len - powLen + 1;
+	ScratchLimbs quotient(qLen);
+	ScratchLimbs remain(len + 1);
+	memcpy(remain, num, len * sizeof(limb_t));
+	remain[len] = 0;
+	divisionUtil(pow, powLen, quotient, qLen, remain);
+	
+	decimalStringUtil(quotient, qLen, out, half);
+	decimalStringUtil(remain, powLen, out + half, half);
 }
 
 char* BigInt::getDecimalString() const
 {
-	static const unsigned char* const* TENS = CREATE_TENS();
-	
 	if(this->numLen == 0)
 	{
 		char* ret = new char[2];
 		ret[0] = '0';
 		ret[1] = 0;
 		return ret;
-	}
-	
-	// {[Length of x(256)] + 1} * log_10(256) gives the length upper bound of the number is decimal.
-	// The +1 at the tail is for the null character, +2 is for the negative sign.
-	int outLen = (this->numLen + 1) * 2.40824 + (this->isNegative ? 2 : 1);
-	int outIndex = outLen - 2;
-	char* _ret = new char[outLen];
-	_ret[outLen - 1] = 0; //null character at the end of the string.
-	
-	unsigned char* quotient = allocZerosMem(this->numLen + 1);
-	unsigned char* cache = new unsigned char[this->numLen + 1];
-	cache[this->numLen] = 0;
-	memcpy(cache, this->number, this->numLen);
-	
-	static unsigned char* swap = nullptr;
+	}
 	
-	int qLen = this->numLen;
-
-	while(qLen > 0)
+	// The digits have been converted already for operator[].
+	if(this->digitCache != nullptr)
 	{
-		bool leadingZero = true;
-		for(int i = qLen - 1 ; i >= 0 ; i--)
+		int sign = this->isNegative ? 1 : 0;
+		char* ret = new char[this->digitCacheLen + sign + 1];
+		if(this->isNegative)
 		{
-			for(int j = 7 ; j >= 0 ; j--)
-			{
-				if(byteWiseGreater(cache + i, TENS[j], 2, true))
-				{
-					leadingZero = false;
-					quotient[i] += (1 << j);
-					byteWiseNegationNoCopy(cache + i, 2, TENS[j], 2, cache + i, 2);
-				}
-			}
-			if(leadingZero)
-			{
-				qLen--;
-			}
+			ret[0] = '-';
 		}
-		
-		_ret[outIndex] = cache[0] + '0';
-		cache[0] = 0;
-		outIndex--;
-		
-		swap = cache;
-		cache = quotient;
-		quotient = swap;
+		for(int i = 0 ; i < this->digitCacheLen ; i++)
+		{
+			ret[sign + i] = this->digitCache[this->digitCacheLen - 1 - i] + '0';
+		}
+		ret[this->digitCacheLen + sign] = 0;
+		return ret;
 	}
 	
-	if(this->isNegative)
+	// {[Length of x(2^64)] + 1} * log_10(2^64) gives the length upper bound of the number is decimal.
+	//  The digits are written zero padded to a power of two times 19, so that the halves split evenly.
+	int maxDigits = (this->numLen + 1) * 19.26592;
+	int digits = TEN_POW_19_DIGITS;
+	while(digits < maxDigits)
 	{
-		_ret[outIndex] = '-';
-		outIndex--;
+		digits *= 2;
 	}
+	char* _ret = new char[digits];
+	decimalStringUtil(this->number, this->numLen, _ret, digits);
 	
-	delete [] quotient;
-	delete [] cache;
+	int shift = 0;
+	while(_ret[shift] == '0')
+	{
+		shift++;
+	}
 	
-	int shift = outIndex + 1;
-	outLen -= shift;
+	// The +1 at the tail is for the null character, +1 is for the negative sign.
+	int sign = this->isNegative ? 1 : 0;
+	int outLen = digits - shift + sign + 1;
 	char* ret = new char[outLen];
-	memcpy(ret, _ret + shift, outLen);
+	if(this->isNegative)
+	{
+		ret[0] = '-';
+	}
+	memcpy(ret + sign, _ret + shift, digits - shift);
+	ret[outLen - 1] = 0; //null character at the end of the string.
 	delete [] _ret;
 	return ret;
 }
 
-short BigInt::operator[](const int index) const
+void BigInt::buildDigitCache() const
 {
-	static const unsigned char* const* TENS = CREATE_TENS();
+	if(this->digitCache != nullptr || this->numLen == 0)
+	{
+		return;
+	}
 	
-	int decLen = (this->numLen + 1) * 2.40824 + 1;
+	int maxDigits = (this->numLen + 1) * 19.26592;
+	int digits = TEN_POW_19_DIGITS;
+	while(digits < maxDigits)
+	{
+		digits *= 2;
+	}
+	char* padded = new char[digits];
+	decimalStringUtil(this->number, this->numLen, padded, digits);
 	
-	if(index > decLen || index < 0)
+	int shift = 0;
+	while(padded[shift] == '0')
+	{
+		shift++;
+	}
+	this->digitCacheLen = digits - shift;
+	this->digitCache = new char[this->digitCacheLen];
+	for(int i = 0 ; i < this->digitCacheLen ; i++)
+	{
+		this->digitCache[i] = padded[digits - 1 - i] - '0';
+	}
+	delete [] padded;
+}
+
+short BigInt::operator[](const int index) const
+{
+	// Digits above the leading one do not exist, and neither does any digit of zero.
+	if(index < 0 || this->numLen == 0)
 	{
 		return -1;
 	}
 	
-	unsigned char* quotient = allocZerosMem(this->numLen + 1);
-	unsigned char* cache = new unsigned char[this->numLen + 1];
-	cache[this->numLen] = 0;
-	memcpy(cache, this->number, this->numLen);
-	
-	static unsigned char* switcher = nullptr;
-	
-	int qLen = this->numLen;
+	this->buildDigitCache();
+	return (index < this->digitCacheLen) ? this->digitCache[index] : -1;
+}
 
-	int indexCount = 0;
-	short ret = -1;
-	while(qLen > 0)
+void BigInt::decimalParseUtil(const limb_t* chunks, int count, limb_t* ret)
+{
+	if(count == 1 || count < DECIMAL_SPLIT_THRESHOLD)
 	{
-		bool leadingZero = true;
-		for(int i = qLen - 1 ; i >= 0 ; i--)
-		{
-			for(int j = 7 ; j >= 0 ; j--)
-			{
-				if(byteWiseGreater(cache + i, TENS[j], 2, true))
-				{
-					leadingZero = false;
-					quotient[i] += (1 << j);
-					byteWiseNegationNoCopy(cache + i, 2, TENS[j], 2, cache + i, 2);
-				}
-			}
-			if(leadingZero)
-			{
-				qLen--;
-			}
-		}
-		
-		if(indexCount == index)
+		// Horner's method on the 19-digit chunks, from the most significant one.
+		memset(ret, 0, count * sizeof(limb_t));
+		ret[0] = chunks[count - 1];
+		int retLen = 1;
+		for(int i = count - 2 ; i >= 0 ; i--)
 		{
-			ret = cache[0];
-			break;
+			ret[retLen] = limbMultiplicationNoCopy(ret, retLen, TEN_POW_19, ret);
+			retLen++;
+			limbWiseAdditionNoCopy(ret, retLen, chunks + i, 1, ret, retLen);
 		}
-		
-		cache[0] = 0;
-		switcher = cache;
-		cache = quotient;
-		quotient = switcher;
-		
-		indexCount++;
+		return;
 	}
 	
-	delete [] quotient;
-	delete [] cache;
-	return ret;
+	// The lower 2^level chunks and the rest are parsed separately, then put together as
+	//  upper * 10^(19 * 2^level) + lower.
+	int level = 0;
+	while((2 << level) < count)
+	{
+		level++;
+	}
+	int lowCount = 1 << level;
+	int highCount = count - lowCount;
+	int powLen;
+	const limb_t* pow = tenPowerUtil(level, powLen);
+	
+	memset(ret + lowCount, 0, highCount * sizeof(limb_t));
+	decimalParseUtil(chunks, lowCount, ret);
+	
+	ScratchLimbs high(highCount + highCount + powLen);
+	limb_t* prod = high + highCount;
+	decimalParseUtil(chunks + lowCount, highCount, high);
+	multiplicationNoCopy(high, highCount, pow, powLen, prod);
+	limbWiseAdditionNoCopy(ret, count, prod, trimmedLen(prod, highCount + powLen), ret, count);
 }
 
-unsigned char* BigInt::createFromDecimal(const char* decimalString, int len, bool& isNeg, int& retLen)
+limb_t* BigInt::createFromDecimal(const char* decimalString, int len, bool& isNeg, int& retLen)
 {
-	isNeg = (decimalString[0] == '-');
-	retLen = (len + (isNeg ? 0 : 1)) / 2;
-
-	unsigned char* retVal = allocZerosMem(retLen);
+	isNeg = (len > 0 && decimalString[0] == '-');
+	const char* digits = decimalString + (isNeg ? 1 : 0);
+	int digitsLen = len - (isNeg ? 1 : 0);
 	
-	unsigned char* digit = new unsigned char(0);
-	
-	unsigned short cache = 0;
-	unsigned char* cPtr = castPtr<unsigned char>(&cache);
-	
-	unsigned short space = 0;
-	
-	for(int i = (isNeg ? 1 : 0) ; i < len ; i++)
+	for(int i = 0 ; i < digitsLen ; i++)
 	{
-		cache = 0;
-		for(int j = 0 ; j < retLen ; j++)
-		{
-			space = retVal[j];
-			cache += space * 10;
-			retVal[j] = *cPtr;
-			cache >>= 8;
-		}
-		
-		if((*digit = (decimalString[i] - '0')) >= 10)
+		if((unsigned char)(digits[i] - '0') >= 10)
 		{
-			delete [] retVal;
 			isNeg = false;
 			retLen = 0;
 			return nullptr; // error (invalid input character) -> return 0.
 		}
-		byteWiseAdditionNoCopy(retVal, retLen, digit, 1, retVal, retLen);
+	}
+	if(digitsLen <= 0)
+	{
+		isNeg = false;
+		retLen = 0;
+		return nullptr;
+	}
+	
+	// Each 19 digits from the tail makes a chunk, which fits into a limb. The value takes at most as many
+	//  limbs as there are chunks.
+	retLen = (digitsLen + TEN_POW_19_DIGITS - 1) / TEN_POW_19_DIGITS;
+	ScratchLimbs chunks(retLen);
+	for(int i = 0 ; i < retLen ; i++)
+	{
+		int end = digitsLen - i * TEN_POW_19_DIGITS;
+		int start = (end > TEN_POW_19_DIGITS) ? (end - TEN_POW_19_DIGITS) : 0;
+		limb_t chunk = 0;
+		for(int j = start ; j < end ; j++)
+		{
+			chunk = chunk * 10 + (digits[j] - '0');
+		}
+		chunks[i] = chunk;
 	}
 	
+	limb_t* retVal = allocLimbArray(retLen);
+	decimalParseUtil(chunks, retLen, retVal);
 	return retVal;
 }
 
@@ -1259,7 +4148,7 @@ BigInt BigInt::createFromDecimal(const char* decimalString, int len)
 {
 	int retLen;
 	bool isNeg;
-	unsigned char* retVal = createFromDecimal(decimalString, len, isNeg, retLen);
+	limb_t* retVal = createFromDecimal(decimalString, len, isNeg, retLen);
 	return BigInt(retVal, isNeg, retLen, nullptr);
 }
 
@@ -1272,7 +4161,7 @@ BigInt* BigInt::createFromDecimal(const char* decimalString, int len, void* dumm
 {
 	int retLen;
 	bool isNeg;
-	unsigned char* retVal = createFromDecimal(decimalString, len, isNeg, retLen);
+	limb_t* retVal = createFromDecimal(decimalString, len, isNeg, retLen);
 	return new BigInt(retVal, isNeg, retLen, nullptr);
 }
 
@@ -1283,76 +4172,493 @@ BigInt* BigInt::createFromDecimal(const char* decimalString, void* dummy)
 
 BigInt::BigInt(const int& copyFrom)
 {
-	int* iPtr = new int(copyFrom);
-	this->isNegative = (*iPtr < 0);
-	if(this->isNegative)
-	{
-		*iPtr = -(*iPtr);
-	}
-	this->byteLen = sizeof(int);
-	this->number = castPtr<unsigned char>(iPtr);
-	for(int i = this->byteLen ; i > 0 ; i--)
+	this->isNegative = (copyFrom < 0);
+	this->allocLimbs(1);
+	this->numLen = 1;
+	
+	// Widened first, so that negating INT_MIN does not overflow.
+	long long value = copyFrom;
+	this->number[0] = (limb_t)(this->isNegative ? -value : value);
+	if(this->number[0] == 0)
 	{
-		if(this->number[i - 1] != 0)
-		{
-			this->numLen = i;
-			return;
-		}
+		this->numLen = 0;
 	}
-	this->numLen = 0;
+	this->digitCache = nullptr;
+	this->digitCacheLen = 0;
 }
 
-const BigInt BigInt::operator+(const int& rhs) const
+BigInt BigInt::operator+(const int& rhs) const &
 {
 	return *this + BigInt(rhs);
 }
 
-const BigInt BigInt::operator-(const int& rhs) const
+BigInt BigInt::operator+(const int& rhs) &&
+{
+	// Widened first, so that negating INT_MIN does not overflow.
+	long long value = rhs;
+	limb_t abs = (limb_t)((rhs < 0) ? -value : value);
+	this->additionInPlace(&abs, (rhs != 0) ? 1 : 0, rhs < 0);
+	return static_cast<BigInt&&>(*this);
+}
+
+BigInt BigInt::operator-(const int& rhs) const &
 {
 	return *this - BigInt(rhs);
 }
 
-const BigInt BigInt::operator*(const int& rhs) const
+BigInt BigInt::operator-(const int& rhs) &&
+{
+	long long value = rhs;
+	limb_t abs = (limb_t)((rhs < 0) ? -value : value);
+	this->additionInPlace(&abs, (rhs != 0) ? 1 : 0, rhs > 0);
+	return static_cast<BigInt&&>(*this);
+}
+
+BigInt BigInt::operator*(const int& rhs) const
 {
 	return *this * BigInt(rhs);
 }
 
-const BigInt BigInt::operator/(const int& rhs) const
+BigInt BigInt::operator/(const int& rhs) const
 {
-	return *this / BigInt(rhs);
+	if(rhs == 0 || this->numLen == 0)
+	{
+		return *this / BigInt(rhs);
+	}
+	
+	// Widened first, so that negating INT_MIN does not overflow.
+	long long value = rhs;
+	BigInt ret(this->numLen, nullptr);
+	limbDivisionNoCopy(this->number, this->numLen, (limb_t)((rhs < 0) ? -value : value), ret.number);
+	ret.numLen = trimmedLen(ret.number, this->numLen);
+	ret.isNegative = (this->isNegative ^ (rhs < 0)) && (ret.numLen > 0);
+	return ret;
 }
 
-const BigInt BigInt::operator%(const int& rhs) const
+BigInt BigInt::operator%(const int& rhs) const
 {
-	return *this % BigInt(rhs);
+	if(rhs == 0 || this->numLen == 0)
+	{
+		return *this % BigInt(rhs);
+	}
+	
+	long long value = rhs;
+	int remain = (int)limbDivisionNoCopy(this->number, this->numLen, (limb_t)((rhs < 0) ? -value : value), nullptr);
+	return BigInt(this->isNegative ? -remain : remain);
 }
 
 const unsigned char * BigInt::getRawBytes() const
 {
-	return this->number;
+	return castPtr<unsigned char>(this->number);
 }
 
-const BigInt operator+(const int& lhs, const BigInt& _this)
+BigInt operator+(const int& lhs, const BigInt& _this)
 {
 	return BigInt(lhs) + _this;
 }
 
-const BigInt operator-(const int& lhs, const BigInt& _this)
+BigInt operator-(const int& lhs, const BigInt& _this)
 {
 	return BigInt(lhs) - _this;
 }
 
-const BigInt operator*(const int& lhs, const BigInt& _this)
+BigInt operator*(const int& lhs, const BigInt& _this)
 {
 	return BigInt(lhs) * _this;
 }
 
-const BigInt operator/(const int& lhs, const BigInt& _this)
+BigInt operator/(const int& lhs, const BigInt& _this)
 {
 	return BigInt(lhs) / _this;
 }
 
-const BigInt operator%(const int& lhs, const BigInt& _this)
+BigInt operator%(const int& lhs, const BigInt& _this)
 {
 	return BigInt(lhs) % _this;
 }
+
+BigIntMontgomery::BigIntMontgomery(const BigInt& mod) : modulus(mod.abs())
+{
+	this->len = this->modulus.numLen;
+	
+	// Newton's iteration doubles the number of correct low bits of m^(-1) each step, starting from 3
+	//  bits (m * m == 1 mod 8 for any odd m).
+	limb_t m0 = this->modulus.number[0];
+	limb_t inv = m0;
+	for(int i = 0 ; i < 5 ; i++)
+	{
+		inv *= 2 - m0 * inv;
+	}
+	this->inverse = 0 - inv;
+	
+	this->one = (BigInt(1) << (LIMB_BITS * this->len)) % this->modulus;
+	this->rSquare = this->one.square() % this->modulus;
+}
+
+void BigIntMontgomery::mulUtil(const limb_t* cand1, const limb_t* cand2, limb_t* ret, limb_t* scratch) const
+{
+	int n = this->len;
+	const limb_t* mod = this->modulus.number;
+	
+	BigInt::multiplicationNoCopy(cand1, n, cand2, n, scratch);
+	scratch[2 * n] = 0;
+	
+	// Each step adds the multiple of m which clears the lowest limb left, so that the product divided by
+	//  R is what remains in the upper <n> + 1 limbs. It's less than 2m.
+	for(int i = 0 ; i < n ; i++)
+	{
+		limb_t carry = BigInt::limbMultiplyAddNoCopy(mod, n, scratch[i] * this->inverse, scratch + i);
+		BigInt::limbWiseAdditionNoCopy(scratch + i + n, n + 1 - i, &carry, 1, scratch + i + n, n + 1 - i);
+	}
+	
+	limb_t* result = scratch + n;
+	if(result[n] != 0 || BigInt::limbWiseGreater(result, mod, n, true))
+	{
+		BigInt::limbWiseNegationNoCopy(result, n + 1, mod, n, result, n + 1);
+	}
+	memcpy(ret, result, n * sizeof(limb_t));
+}
+
+void BigIntMontgomery::padUtil(const BigInt& value, limb_t* ret) const
+{
+	memcpy(ret, value.number, value.numLen * sizeof(limb_t));
+	memset(ret + value.numLen, 0, (this->len - value.numLen) * sizeof(limb_t));
+}
+
+BigInt BigIntMontgomery::toMontgomery(const BigInt& value) const
+{
+	BigInt reduced = value % this->modulus;
+	if(reduced.isNegative)
+	{
+		reduced += this->modulus;
+	}
+	
+	int n = this->len;
+	ScratchLimbs space(4 * n + 1);
+	this->padUtil(reduced, space);
+	this->padUtil(this->rSquare, space + n);
+	
+	limb_t* ret = BigInt::allocLimbArray(n);
+	this->mulUtil(space, space + n, ret, space + 2 * n);
+	return BigInt(ret, false, n, nullptr);
+}
+
+BigInt BigIntMontgomery::fromMontgomery(const BigInt& value) const
+{
+	int n = this->len;
+	ScratchLimbs space(4 * n + 1);
+	this->padUtil(value, space);
+	memset(space + n, 0, n * sizeof(limb_t));
+	space[n] = 1;
+	
+	limb_t* ret = BigInt::allocLimbArray(n);
+	this->mulUtil(space, space + n, ret, space + 2 * n);
+	return BigInt(ret, false, n, nullptr);
+}
+
+BigInt BigIntMontgomery::mul(const BigInt& cand1, const BigInt& cand2) const
+{
+	if(&cand1 == &cand2)
+	{
+		return this->sqr(cand1);
+	}
+	
+	int n = this->len;
+	ScratchLimbs space(4 * n + 1);
+	this->padUtil(cand1, space);
+	this->padUtil(cand2, space + n);
+	
+	limb_t* ret = BigInt::allocLimbArray(n);
+	this->mulUtil(space, space + n, ret, space + 2 * n);
+	return BigInt(ret, false, n, nullptr);
+}
+
+BigInt BigIntMontgomery::sqr(const BigInt& cand) const
+{
+	int n = this->len;
+	ScratchLimbs space(3 * n + 1);
+	this->padUtil(cand, space);
+	
+	limb_t* ret = BigInt::allocLimbArray(n);
+	this->mulUtil(space, space, ret, space + n);
+	return BigInt(ret, false, n, nullptr);
+}
+
+// Width of the window for a sliding-window exponentiation with an exponent of <bits> bits, which balances
+//  the squarings saved against the odd powers to be computed beforehand.
+static int windowBits(int bits)
+{
+	static const int LIMITS[] = {7, 36, 140, 450, 1303, 3529};
+	int window = 1;
+	while(window <= 6 && bits > LIMITS[window - 1])
+	{
+		window++;
+	}
+	return window;
+}
+
+BigInt BigIntMontgomery::pow(const BigInt& base, const BigInt& exp) const
+{
+	if(exp.numLen == 0 || exp.isNegative)
+	{
+		return this->one;
+	}
+	
+	int n = this->len;
+	int bits = exp.numLen * LIMB_BITS - countLeadingZeros(exp.number[exp.numLen - 1]);
+	int window = windowBits(bits);
+	int tableSize = 1 << (window - 1);
+	
+	ScratchLimbs space(tableSize * n + 3 * n + 1);
+	limb_t* table = space;
+	limb_t* acc = table + tableSize * n;
+	limb_t* scratch = acc + n;
+	
+	// The odd powers base^1, base^3, ..., base^(2^window - 1).
+	this->padUtil(base, table);
+	if(tableSize > 1)
+	{
+		this->mulUtil(table, table, acc, scratch);
+		for(int i = 1 ; i < tableSize ; i++)
+		{
+			this->mulUtil(table + (i - 1) * n, acc, table + i * n, scratch);
+		}
+	}
+	
+	// The exponent is walked from the top. A zero bit takes a squaring, and a set bit starts the longest
+	//  window (of at most <window> bits) which ends with a set bit, taking a squaring for each bit of it
+	//  and a multiplication by the odd power it makes.
+	bool started = false;
+	int bit = bits - 1;
+	while(bit >= 0)
+	{
+		if(!limbBit(exp.number, bit))
+		{
+			this->mulUtil(acc, acc, acc, scratch);
+			bit--;
+			continue;
+		}
+		
+		int low = (bit >= window) ? (bit - window + 1) : 0;
+		while(!limbBit(exp.number, low))
+		{
+			low++;
+		}
+		int value = 0;
+		for(int i = bit ; i >= low ; i--)
+		{
+			value = (value << 1) | limbBit(exp.number, i);
+		}
+		
+		if(started)
+		{
+			for(int i = bit ; i >= low ; i--)
+			{
+				this->mulUtil(acc, acc, acc, scratch);
+			}
+			this->mulUtil(acc, table + (value >> 1) * n, acc, scratch);
+		}
+		else
+		{
+			memcpy(acc, table + (value >> 1) * n, n * sizeof(limb_t));
+			started = true;
+		}
+		bit = low - 1;
+	}
+	
+	limb_t* ret = BigInt::allocLimbArray(n);
+	memcpy(ret, acc, n * sizeof(limb_t));
+	return BigInt(ret, false, n, nullptr);
+}
+
+const BigInt& BigIntMontgomery::getModulus() const
+{
+	return this->modulus;
+}
+
+BigIntPrimeSieve::BigIntPrimeSieve(const BigInt& start, bool downward)
+{
+	const SmallPrimeTable& table = smallPrimes();
+	this->survivors = new bool[PRIME_SIEVE_SEGMENT];
+	this->offsets = new int[table.count];
+	this->downward = downward;
+	
+	if(!downward)
+	{
+		this->twoPending = start <= 2;
+		this->lo = this->twoPending ? BigInt(3) : start;
+		if(!(this->lo.number[0] & 1))
+		{
+			this->lo += 1;
+		}
+		this->count = PRIME_SIEVE_SEGMENT;
+	}
+	else
+	{
+		this->twoPending = start >= 2;
+		BigInt hi = start;
+		if(start >= 3 && !(hi.number[0] & 1))
+		{
+			hi -= 1;
+		}
+		if(hi < 3)
+		{
+			// Nothing but 2 (if any) is left.
+			this->lo = 3;
+			this->count = 0;
+		}
+		else
+		{
+			this->lo = hi - 2 * (PRIME_SIEVE_SEGMENT - 1);
+			this->count = PRIME_SIEVE_SEGMENT;
+			if(this->lo < 3)
+			{
+				this->count = (int)((hi.number[0] - 3) / 2) + 1;
+				this->lo = 3;
+			}
+		}
+	}
+	
+	this->offsetsUtil();
+	this->sieveUtil();
+	this->pos = downward ? this->count - 1 : 0;
+}
+
+BigIntPrimeSieve::~BigIntPrimeSieve()
+{
+	delete [] this->survivors;
+	delete [] this->offsets;
+}
+
+void BigIntPrimeSieve::offsetsUtil()
+{
+	const SmallPrimeTable& table = smallPrimes();
+	int level = 0;
+	int groupCount;
+	while(BigInt::primeTreeUtil(level + 1, groupCount) != nullptr)
+	{
+		level++;
+	}
+	ScratchLimbs remainders(table.groupCount);
+	BigInt::remainderTreeUtil(this->lo.number, this->lo.numLen, level, 0, remainders);
+	
+	// lo + 2 * i is a multiple of p when i = -lo / 2 (mod p), and 1 / 2 = (p + 1) / 2 (mod p).
+	for(int i = 0 ; i < table.groupCount ; i++)
+	{
+		for(int j = table.groupStarts[i] ; j < table.groupStarts[i + 1] ; j++)
+		{
+			limb_t p = table.primes[j];
+			limb_t r = remainders[i] % p;
+			this->offsets[j] = (int)((p - r) % p * ((p + 1) / 2) % p);
+		}
+	}
+}
+
+void BigIntPrimeSieve::sieveUtil()
+{
+	const SmallPrimeTable& table = smallPrimes();
+	memset(this->survivors, true, this->count * sizeof(bool));
+	
+	// Below a small prime, the first multiple of it in the segment is the prime itself, which stays.
+	limb_t small = (this->lo.numLen <= 1) ? this->lo.number[0] : ~(limb_t)0;
+	for(int i = 0 ; i < table.count ; i++)
+	{
+		int p = (int)table.primes[i];
+		int j = this->offsets[i];
+		if(small <= (limb_t)p)
+		{
+			j += p;
+		}
+		for( ; j < this->count ; j += p)
+		{
+			this->survivors[j] = false;
+		}
+	}
+}
+
+bool BigIntPrimeSieve::advanceUtil()
+{
+	const SmallPrimeTable& table = smallPrimes();
+	if(!this->downward)
+	{
+		this->lo += 2 * PRIME_SIEVE_SEGMENT;
+		for(int i = 0 ; i < table.count ; i++)
+		{
+			int p = (int)table.primes[i];
+			this->offsets[i] = (this->offsets[i] + p - PRIME_SIEVE_SEGMENT % p) % p;
+		}
+		this->sieveUtil();
+		this->pos = 0;
+		return true;
+	}
+	
+	if(this->lo <= 3)
+	{
+		return false;
+	}
+	BigInt hi = this->lo - 2;
+	this->lo -= 2 * PRIME_SIEVE_SEGMENT;
+	if(this->lo < 3)
+	{
+		// The last segment is cut at 3, and so is it's shift.
+		this->count = (int)((hi.number[0] - 3) / 2) + 1;
+		this->lo = 3;
+		this->offsetsUtil();
+	}
+	else
+	{
+		for(int i = 0 ; i < table.count ; i++)
+		{
+			int p = (int)table.primes[i];
+			this->offsets[i] = (this->offsets[i] + PRIME_SIEVE_SEGMENT) % p;
+		}
+	}
+	this->sieveUtil();
+	this->pos = this->count - 1;
+	return true;
+}
+
+bool BigIntPrimeSieve::testUtil(const BigInt& value)
+{
+	if(value.numLen <= 1)
+	{
+		return BigInt::primeLimbUtil(value.number[0]);
+	}
+	BigIntMontgomery context(value);
+	return BigInt::millerRabinUtil(context, BigInt(2)) && BigInt::lucasUtil(context);
+}
+
+BigInt BigIntPrimeSieve::next()
+{
+	if(!this->downward && this->twoPending)
+	{
+		this->twoPending = false;
+		return BigInt(2);
+	}
+	
+	int step = this->downward ? -1 : 1;
+	do
+	{
+		while(this->pos >= 0 && this->pos < this->count)
+		{
+			int at = this->pos;
+			this->pos += step;
+			if(this->survivors[at])
+			{
+				BigInt value = this->lo + 2 * at;
+				if(testUtil(value))
+				{
+					return value;
+				}
+			}
+		}
+	}
+	while(this->advanceUtil());
+	
+	if(this->twoPending)
+	{
+		this->twoPending = false;
+		return BigInt(2);
+	}
+	return BigInt();
+}
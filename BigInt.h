@@ -9,6 +9,163 @@
 #ifndef _TANGENTS_BIGINT_H
 #define _TANGENTS_BIGINT_H 65536
 
+/*
+ * The value of a BigInt is stored as an array of 64-bit limbs, least significant limb first.
+ *  Byte-level access (getRawBytes() and the "const char*" constructor) assumes a little-endian
+ *  machine, so that the limb array reads as a plain little-endian byte array.
+ */
+typedef unsigned long long limb_t;
+
+/*
+ * Values up to this many limbs are stored inside the BigInt itself instead of on the heap. It MUST be
+ *  the same for every translation unit including this header.
+ */
+#ifndef BIGINT_INLINE_LIMBS
+#define BIGINT_INLINE_LIMBS 4
+#endif
+
+/*
+ * Size classes of BigIntPool, where the class c holds arrays of 2^c limbs. Longer arrays bypass the pool.
+ */
+#define BIGINT_POOL_CLASSES 24
+
+class BigInt;
+
+/*
+ * A source of limb arrays. Every limb array taken by a BigInt, and the scratch space of it's internal
+ *  routines, comes from the allocator installed for the current thread, or from "new" if there's none.
+ *  An array always goes back to the allocator it came from, no matter which one is installed by then.
+ */
+class BigIntAllocator
+{
+    public:
+        virtual ~BigIntAllocator() {}
+        
+        /*
+         * Returns space for at least <len> limbs, which is NOT zeroed.
+         */
+        virtual limb_t* allocate(int len) = 0;
+        
+        /*
+         * Takes back the space of <len> limbs returned by allocate() with the same length.
+         */
+        virtual void release(limb_t* space, int len) = 0;
+        
+        /*
+         * Installs an allocator for the current thread, or nullptr to go back to "new".
+         *
+         * Param:
+         *     allocator    -> (in) The allocator to be used from now on. It MUST outlive every limb array
+         *                      taken from it.
+         *
+         * Returns:
+         *     _ret         -> The allocator which was installed before.
+         */
+        static BigIntAllocator* install(BigIntAllocator* allocator);
+        
+        /*
+         * Returns the allocator installed for the current thread, or nullptr if there's none.
+         */
+        static BigIntAllocator* installed();
+};
+
+/*
+ * Keeps the freed limb arrays in lists by size class (powers of two), so that temporaries of similar
+ *  sizes reuse the space instead of going through the global heap each time. It's NOT thread-safe, so
+ *  arrays taken from a pool MUST be freed on the thread which owns the pool.
+ */
+class BigIntPool : public BigIntAllocator
+{
+    private:
+        // Free arrays of each size class, linked through their first limb.
+        limb_t* freeLists[BIGINT_POOL_CLASSES];
+        
+        // Number of arrays in each list.
+        int freeCounts[BIGINT_POOL_CLASSES];
+    
+    public:
+        BigIntPool();
+        
+        // Frees all the arrays kept by the pool.
+        ~BigIntPool();
+        
+        limb_t* allocate(int len);
+        
+        void release(limb_t* space, int len);
+        
+        /*
+         * Returns the pool of the current thread, which lives until the thread exits. Install it with
+         *  BigIntAllocator::install() to use it.
+         */
+        static BigIntPool& forThisThread();
+};
+
+/*
+ * Hands out limb arrays from big chunks and frees all of them at once when it's destroyed, which suits
+ *  a computation with a bounded lifetime. It installs itself for the current thread when it's created,
+ *  and puts the previous allocator back when it's destroyed.
+ *
+ * Any BigInt created or CHANGED in the scope of an arena may hold it's space, so it MUST NOT be used
+ *  (or even destroyed) after the arena is gone. Copy the results out with keep() while the arena is
+ *  still alive, or convert them with getDecimalString(), to keep them.
+ */
+class BigIntArena : public BigIntAllocator
+{
+    private:
+        // The chunks, each of which links to the previous one through it's first limb.
+        limb_t* chunks;
+        
+        // Where the next array is cut from, and the end of the current chunk.
+        limb_t* next;
+        limb_t* end;
+        
+        // Length of the chunk to be taken next.
+        int chunkLen;
+        
+        // The allocator to be put back.
+        BigIntAllocator* previous;
+        
+        BigIntArena(const BigIntArena&);
+        BigIntArena& operator=(const BigIntArena&);
+    
+    public:
+        /*
+         * Creates an arena and installs it.
+         *
+         * Param:
+         *     initialLen    -> (in) Length in limbs of the first chunk. The later ones double in size.
+         */
+        BigIntArena(int initialLen = 4096);
+        
+        ~BigIntArena();
+        
+        limb_t* allocate(int len);
+        
+        // Only the last array handed out is taken back, so that scratch space freed in reverse order
+        //  is reused. The others stay until the arena is destroyed.
+        void release(limb_t* space, int len);
+        
+        /*
+         * Returns a copy of a BigInt whose space comes from the allocator that was installed before this
+         *  arena (the one to be put back, which is the enclosing arena if there's one), so that it outlives
+         *  the arena. The copy MUST NOT be changed again in the scope of the arena, which would move it
+         *  back into the arena.
+         *
+         * Param:
+         *     value    -> (in) The BigInt to be kept, which MAY hold the space of this arena.
+         *
+         * Returns:
+         *     _ret     -> The copy.
+         */
+        BigInt keep(const BigInt& value);
+};
+
+template<class E> class BigIntExpression;
+template<class L, class R> class BigIntProduct;
+class BigIntRef;
+class BigIntMontgomery;
+class BigIntPrimeSieve;
+
 class BigInt
 {
     /*
@@ -23,30 +180,42 @@ class BigInt
      * If you HAVE to use these functions for some reason(s), PLEASE READ
      *  THE DESCRIPTION CAREFULLY BEFORE USING THEM!
      *
-     * Notes: "byte array" and "char array" stand for literally the same
-     *  variable type in the following descriptions.
+     * Notes: "limb array" stands for an array of limb_t, and all lengths
+     *  in the following descriptions are counted in limbs unless stated
+     *  otherwise.
      */
     private:
-        // Length of the content char array which stores the value.
-        int byteLen;
+        // Length of the content limb array which stores the value.
+        int limbLen;
         
-        // Length of the char array part without the leading zero(s).
+        // Length of the limb array part without the leading zero(s).
         int numLen;
         
-        // The content (value).
-        unsigned char* number;
+        // The content (value), least significant limb first. Points to <inlineLimbs> while the value
+        //  fits in there, or an array on the heap otherwise.
+        limb_t* number;
+        
+        // Inline space for small values, so that they never touch the heap.
+        limb_t inlineLimbs[BIGINT_INLINE_LIMBS];
         
         // Negative.
         bool isNegative;
         
+        // Decimal digits of the absolute value, least significant first (as 0 ~ 9, not characters),
+        //  built by operator[] on demand. nullptr if not built yet or the value has changed since.
+        mutable char* digitCache;
+        
+        // Length of <digitCache>, which is the number of decimal digits.
+        mutable int digitCacheLen;
+        
         /*
-         * Creates an empty BigInt with _byteLen bytes of space.
+         * Creates an empty BigInt with _limbLen limbs of space.
          *
          * Params:
-         *     _byteLen    -> (in) Length of the content byte array (which will be filled with zeros).
+         *     _limbLen    -> (in) Length of the content limb array (which will be filled with zeros).
          *     dummy       -> (in) Just for recognizing this constructor.
          */
-        BigInt(const int _byteLen, void* dummy);
+        BigInt(const int _limbLen, void* dummy);
         
         /*
          * Creates a BigInt with the content _num.
@@ -54,146 +223,494 @@ class BigInt
          * Params:
          *     _num     -> (in/dangerous) Value of this BigInt WITHOUT copying.
          *     _isNeg   -> (in) hether this BigInt should be negative.
-         *     _len     -> (in) Length of the content byte array.
+         *     _len     -> (in) Length of the content limb array.
          *     copy     -> (in) Dummy place holder just for recognizing this constructor.
          */
-        BigInt(unsigned char* _num, bool _isNeg, int _len, void* copy);
+        BigInt(limb_t* _num, bool _isNeg, int _len, void* copy);
         
         /*
          * Creates a BigInt with the content _num.
          *
          * Params:
          *     newNumber      -> (in/dangerous) New value of this BigInt WITHOUT copying.
-         *     newByteLen     -> (in) Length of the content byte array.
+         *     newLimbLen     -> (in) Length of the content limb array.
          *     isNegative     -> (in) hether this BigInt should be negative.
          */
-        void setValues(unsigned char* newNumber, int newByteLen, bool isNegative);
+        void setValues(limb_t* newNumber, int newLimbLen, bool isNegative);
+        
+        /*
+         * Points the content at zeroed space of at least _len limbs, which is <inlineLimbs> if it fits.
+         *  The old content is NOT freed, so call releaseLimbs() first unless it's never been set.
+         *
+         * Params:
+         *     _len     -> (in) The least length of the content limb array.
+         */
+        void allocLimbs(int _len);
+        
+        /*
+         * Frees the content limb array if it's on the heap.
+         */
+        void releaseLimbs();
+        
+        /*
+         * Makes room for at least _len limbs in the content limb array, keeping the value.
+         *
+         * Params:
+         *     _len     -> (in) The least length of the content limb array.
+         */
+        void growLimbs(int _len);
+        
+        /*
+         * Takes over the content of another BigInt, which is left as zero. The limbs are copied if they
+         *  are inline, or the heap array is taken otherwise. The old content of this BigInt MUST have
+         *  been freed.
+         *
+         * Params:
+         *     moveFrom -> (in/out) The BigInt to be taken from.
+         */
+        void takeLimbs(BigInt& moveFrom);
+        
+        /*
+         * Adds a signed value to this BigInt. The result is written into the content limb array
+         *  of this BigInt, which grows geometrically if there's no room for it.
+         *
+         * Params:
+         *     num            -> (in) The absolute value to be added. It MAY be the content of this BigInt.
+         *     len            -> (in) Length of <num> without the leading zero(s).
+         *     neg            -> (in) Whether the value to be added is negative.
+         */
+        void additionInPlace(const limb_t* num, int len, bool neg);
+        
+        /*
+         * Adds the product of two BigInts to this BigInt, without creating a BigInt for the product.
+         *
+         * Params:
+         *     mult1          -> (in) The first factor. It MAY be this BigInt.
+         *     mult2          -> (in) The second factor. It MAY be this BigInt.
+         *     negate         -> (in) Whether the product is subtracted instead.
+         */
+        void multiplyAddInPlace(const BigInt& mult1, const BigInt& mult2, bool negate);
         
         /*
-         * Preforms absolute-value byte-wise addition of two byte arrays and stores the result into a third one. The length of the first byte array MUST be not less than the second one.
+         * Adds a signed multiple of a limb array to this BigInt in a single pass over the limbs, without
+         *  creating the product.
+         *
+         * Params:
+         *     num            -> (in) The absolute value to be multiplied. It MAY be the content of this BigInt.
+         *     len            -> (in) Length of <num> without the leading zero(s).
+         *     mult           -> (in) The limb to multiply <num> by.
+         *     neg            -> (in) Whether the product to be added is negative.
+         */
+        void limbMultiplyAddInPlace(const limb_t* num, int len, limb_t mult, bool neg);
+        
+        /*
+         * Sets this BigInt to zero, keeping the space of the content limb array.
+         */
+        void setZero();
+        
+        template<class L, class R> friend class BigIntProduct;
+        friend class BigIntMontgomery;
+        friend class BigIntPrimeSieve;
+        
+        /*
+         * Drops the cached decimal digits. Every method changing the value MUST call this.
+         */
+        void clearDigitCache();
+        
+        /*
+         * Builds the cached decimal digits if they are not built yet.
+         */
+        void buildDigitCache() const;
+        
+        /*
+         * Preforms absolute-value limb-wise addition of two limb arrays and stores the result into a third one. The length of the first limb array MUST be not less than the second one.
          *
          * Params:
          *     cand1      -> (in) The value of the first candidate, a.k.a augend.
-         *     len1       -> (in) Length of <cand1> in bytes.
+         *     len1       -> (in) Length of <cand1> in limbs.
          *     cand2      -> (in) The value of the second candidate, a.k.a addends.
-         *     len2       -> (in) Length of <cand2> in bytes.
-         *     ret        -> (out) The byte array where the result will be stored in.
-         *     bLenOut    -> (in) Length of <ret> in bytes.
+         *     len2       -> (in) Length of <cand2> in limbs.
+         *     ret        -> (out) The limb array where the result will be stored in. It may be the same array as <cand1> or <cand2>.
+         *     lenOut     -> (in) Length of <ret> in limbs.
+         *
+         * Returns:
+         *     _ret       -> The carry out of the leading limb of <cand1>.
          */
-        static void byteWiseAdditionNoCopy(const unsigned char* cand1, int len1, const unsigned char* cand2, int len2, unsigned char* ret, int bLenOut);
+        static limb_t limbWiseAdditionNoCopy(const limb_t* cand1, int len1, const limb_t* cand2, int len2, limb_t* ret, int lenOut);
         
         /*
-         * Preforms absolute-value byte-wise negation of two byte arrays and stores the result into a third one. The first candidate MUST be greater than the second one.
+         * Preforms absolute-value limb-wise negation of two limb arrays and stores the result into a third one. The first candidate MUST be greater than the second one.
          *
          * Params:
          *     cand1      -> (in) The value of the first candidate, a.k.a. minuend.
-         *     len1       -> (in) Length of <cand1> in bytes, which MUST be NOT LESS than len2.
+         *     len1       -> (in) Length of <cand1> in limbs, which MUST be NOT LESS than len2.
          *     cand2      -> (in) The value of the second candidate, a.k.a subtrahend.
-         *     len2       -> (in) Length of <cand2> in bytes.
-         *     ret        -> (out) The byte array where the result will be stored in.
-         *     bLenOut    -> (in) Length of <ret> in bytes.
+         *     len2       -> (in) Length of <cand2> in limbs.
+         *     ret        -> (out) The limb array where the result will be stored in. It may be the same array as <cand1> or <cand2>.
+         *     lenOut     -> (in) Length of <ret> in limbs.
+         *
+         * Returns:
+         *     _ret       -> The borrow out of the leading limb of <cand1>, which is 0 if the precondition is met.
          */
-		static void byteWiseNegationNoCopy(const unsigned char* cand1, int len1, const unsigned char* cand2, int len2, unsigned char* ret, int bLenOut);
+		static limb_t limbWiseNegationNoCopy(const limb_t* cand1, int len1, const limb_t* cand2, int len2, limb_t* ret, int lenOut);
         
         /*
-         * Preforms absolute-value byte-wise addition of two byte arrays and returns the result.
+         * Preforms absolute-value limb-wise addition of two limb arrays and returns the result.
          *
          * Params:
          *     cand1      -> (in) The value of the first candidate, a.k.a augend.
-         *     len1       -> (in) Length of <cand1> in bytes.
+         *     len1       -> (in) Length of <cand1> in limbs.
          *     cand2      -> (in) The value of the second candidate, a.k.a addends.
-         *     len2       -> (in) Length of <cand2> in bytes.
-         *     bLenOut    -> (out) Length of the returned char array in bytes. This will be automatically calculated.
+         *     len2       -> (in) Length of <cand2> in limbs.
+         *     lenOut     -> (out) Length of the returned limb array. This will be automatically calculated.
          *
          * Returns:
-         *     _ret       -> The byte array where the result is stored in, with it's length equals to <bLenOut>.
+         *     _ret       -> The limb array where the result is stored in, with it's length equals to <lenOut>.
          */
-        static unsigned char* byteWiseAddition(const unsigned char* cand1, int len1, const unsigned char* cand2, int len2, int& bLenOut);
+        static limb_t* limbWiseAddition(const limb_t* cand1, int len1, const limb_t* cand2, int len2, int& lenOut);
         
         /*
-         * Preforms absolute-value byte-wise negation of two byte arrays and returns the result. The first candidate MUST be greater than the second one.
+         * Preforms absolute-value limb-wise negation of two limb arrays and returns the result. The first candidate MUST be greater than the second one.
          *
          * Params:
          *     cand1      -> (in) The value of the first candidate, a.k.a. minuend.
-         *     len1       -> (in) Length of <cand1> in bytes, which MUST be NOT LESS than len2.
+         *     len1       -> (in) Length of <cand1> in limbs, which MUST be NOT LESS than len2.
          *     cand2      -> (in) The value of the second candidate, a.k.a subtrahend.
-         *     len2       -> (in) Length of <cand2> in bytes.
-         *     bLenOut    -> (out) Length of the returned char array in bytes. This will be automatically calculated.
+         *     len2       -> (in) Length of <cand2> in limbs.
+         *     lenOut     -> (out) Length of the returned limb array. This will be automatically calculated.
          *
          * Returns:
-         *     _ret       -> The byte array where the result is stored in, with it's length equals to <bLenOut>.
+         *     _ret       -> The limb array where the result is stored in, with it's length equals to <lenOut>.
          */
-		static unsigned char* byteWiseNegation(const unsigned char* cand1, int len1, const unsigned char* cand2, int len2, int& bLenOut);
+		static limb_t* limbWiseNegation(const limb_t* cand1, int len1, const limb_t* cand2, int len2, int& lenOut);
         
         /*
-         * Shifts the input byte array by specific bits and returns the result as a NEW char array.
+         * Shifts the input limb array by specific bits and returns the result as a NEW limb array.
          *
          * Params:
          *     offset     -> (in) Bits of the shifting. Positive values stand for left-shifting, and negative values stand for right-shifting.
          *     cand1      -> (in) The value to be shifted.
-         *     len1       -> (in) Length of <cand1> in bytes.
-         *     bLenOut    -> (out) Length of the returned char array in bytes. This will be automatically calculated.
+         *     len1       -> (in) Length of <cand1> in limbs.
+         *     lenOut     -> (out) Length of the returned limb array. This will be automatically calculated.
          *
          * Returns:
-         *     _ret       -> The byte array where the result is stored in, with it's length equals to <bLenOut>.
+         *     _ret       -> The limb array where the result is stored in, with it's length equals to <lenOut>.
+         *                    nullptr is returned (with <lenOut> set to 0) if everything is shifted out.
          */
-        static unsigned char* shiftBits(const int offset, const unsigned char* cand1, int len1, int& bLenOut);
+        static limb_t* shiftBits(const int offset, const limb_t* cand1, int len1, int& lenOut);
         
         /*
-         * Multiplies two byte arrays and returns the result.
+         * Multiplies two limb arrays and returns the result.
          *
          * Params:
          *     cand1      -> (in) The value of the first candidate, a.k.a multiplier.
-         *     len1       -> (in) Length of <cand1> in bytes.
+         *     len1       -> (in) Length of <cand1> in limbs.
          *     cand2      -> (in) The value of the second candidate, a.k.a multiplicand.
-         *     len2       -> (in) Length of <cand2> in bytes.
-         *     bLenOut    -> (out) Length of the returned char array in bytes. This will be automatically calculated.
+         *     len2       -> (in) Length of <cand2> in limbs.
+         *     newLen     -> (out) Length of the returned limb array. This will be automatically calculated.
          *
          * Returns:
-         *     _ret       -> The byte array where the result is stored in, with it's length equals to <bLenOut>.
+         *     _ret       -> The limb array where the result is stored in, with it's length equals to <newLen>.
          */
-        static unsigned char* multiplicationUtil(const unsigned char* cand1, int len1, const unsigned char* cand2, int len2, int& newBLen);
-        
+        static limb_t* multiplicationUtil(const limb_t* cand1, int len1, const limb_t* cand2, int len2, int& newLen);
+
+        /*
+         * Multiplies two limb arrays and stores the product into a third one, picking the algorithm by the
+         *  lengths of the candidates. Passing the same limb array as both candidates squares it, which takes
+         *  the squaring variant of each algorithm.
+         *
+         * Params:
+         *     cand1      -> (in) The value of the first candidate, a.k.a multiplier.
+         *     len1       -> (in) Length of <cand1> in limbs, which MUST be positive.
+         *     cand2      -> (in) The value of the second candidate, a.k.a multiplicand.
+         *     len2       -> (in) Length of <cand2> in limbs, which MUST be positive.
+         *     ret        -> (out) The limb array where the product will be stored in, with it's length equals to
+         *                    [<len1> + <len2>]. It MUST NOT overlap with the candidates.
+         */
+        static void multiplicationNoCopy(const limb_t* cand1, int len1, const limb_t* cand2, int len2, limb_t* ret);
+
+        /*
+         * Multiplies two limb arrays by the schoolbook method and stores the product into a third one.
+         *  The same limb array passed twice is handed to schoolbookSquareNoCopy().
+         *
+         * Params:
+         *     cand1      -> (in) The value of the first candidate, a.k.a multiplier.
+         *     len1       -> (in) Length of <cand1> in limbs, which MUST be positive.
+         *     cand2      -> (in) The value of the second candidate, a.k.a multiplicand.
+         *     len2       -> (in) Length of <cand2> in limbs, which MUST be positive.
+         *     ret        -> (out) The limb array where the product will be stored in, with it's length equals to
+         *                    [<len1> + <len2>]. It MUST NOT overlap with the candidates.
+         */
+        static void schoolbookMultiplicationNoCopy(const limb_t* cand1, int len1, const limb_t* cand2, int len2, limb_t* ret);
+
+        /*
+         * Squares a limb array by the schoolbook method and stores the result into another one. Each product
+         *  of two different limbs is computed only once and doubled.
+         *
+         * Params:
+         *     cand       -> (in) The value of the limb array.
+         *     len        -> (in) Length of <cand> in limbs, which MUST be positive.
+         *     ret        -> (out) The limb array where the square will be stored in, with it's length equals to
+         *                    [2 * <len>]. It MUST NOT overlap with <cand>.
+         */
+        static void schoolbookSquareNoCopy(const limb_t* cand, int len, limb_t* ret);
+
+        /*
+         * Multiplies two limb arrays of the same length by the Karatsuba method and stores the product into a
+         *  third one. Halves shorter than KARATSUBA_THRESHOLD are multiplied by the schoolbook method.
+         *  If <cand1> and <cand2> are the same limb array, the three sub-products are squares.
+         *
+         * Params:
+         *     cand1      -> (in) The value of the first candidate, a.k.a multiplier.
+         *     cand2      -> (in) The value of the second candidate, a.k.a multiplicand.
+         *     len        -> (in) Length of both <cand1> and <cand2> in limbs.
+         *     ret        -> (out) The limb array where the product will be stored in, with it's length equals to
+         *                    [2 * <len>]. It MUST NOT overlap with the candidates.
+         *     scratch    -> (in/out) Working space, whose length is given by karatsubaScratchLen(<len>).
+         */
+        static void karatsubaMultiplicationNoCopy(const limb_t* cand1, const limb_t* cand2, int len, limb_t* ret, limb_t* scratch);
+
+        /*
+         * Multiplies two limb arrays of the same length by the Toom-Cook 3-way method and stores the product
+         *  into a third one. The candidates are split into 3 parts and evaluated at 0, 1, -1, 2 and infinity.
+         *  If <cand1> and <cand2> are the same limb array, it's evaluated once and the five sub-products are
+         *  squares.
+         *
+         * Params:
+         *     cand1      -> (in) The value of the first candidate, a.k.a multiplier.
+         *     cand2      -> (in) The value of the second candidate, a.k.a multiplicand.
+         *     len        -> (in) Length of both <cand1> and <cand2> in limbs, which MUST be greater than 4.
+         *     ret        -> (out) The limb array where the product will be stored in, with it's length equals to
+         *                    [2 * <len>]. It MUST NOT overlap with the candidates.
+         */
+        static void toom3MultiplicationNoCopy(const limb_t* cand1, const limb_t* cand2, int len, limb_t* ret);
+
+        /*
+         * Multiplies two limb arrays of unbalanced lengths by the Toom-2.5 method and stores the product into a
+         *  third one. The longer candidate is split into 3 parts and the shorter one into 2 parts, which are
+         *  evaluated at 0, 1, -1 and infinity.
+         *
+         * Params:
+         *     cand1      -> (in) The value of the first candidate, a.k.a multiplier.
+         *     len1       -> (in) Length of <cand1> in limbs, which MUST be in [1.25 * <len2>, 2 * <len2>).
+         *     cand2      -> (in) The value of the second candidate, a.k.a multiplicand.
+         *     len2       -> (in) Length of <cand2> in limbs, which MUST be greater than 4.
+         *     ret        -> (out) The limb array where the product will be stored in, with it's length equals to
+         *                    [<len1> + <len2>]. It MUST NOT overlap with the candidates.
+         */
+        static void toom32MultiplicationNoCopy(const limb_t* cand1, int len1, const limb_t* cand2, int len2, limb_t* ret);
+
+        /*
+         * Multiplies two limb arrays by number-theoretic transforms and stores the product into a third one.
+         *  Each limb is a coefficient, the convolution is done modulo three primes below 2^63 and the
+         *  coefficients of the product are put back together by the Chinese remainder theorem. Squaring the
+         *  same limb array takes one forward transform instead of two.
+         *
+         * Params:
+         *     cand1      -> (in) The value of the first candidate, a.k.a multiplier.
+         *     len1       -> (in) Length of <cand1> in limbs, which MUST be positive.
+         *     cand2      -> (in) The value of the second candidate, a.k.a multiplicand.
+         *     len2       -> (in) Length of <cand2> in limbs, which MUST be positive.
+         *     ret        -> (out) The limb array where the product will be stored in, with it's length equals to
+         *                    [<len1> + <len2>]. It MAY overlap with the candidates.
+         */
+        static void nttMultiplicationNoCopy(const limb_t* cand1, int len1, const limb_t* cand2, int len2, limb_t* ret);
+
+        /*
+         * Multiplies a limb array by a single limb and stores the result into another one.
+         *
+         * Params:
+         *     cand1      -> (in) The value of the limb array.
+         *     len1       -> (in) Length of <cand1> in limbs.
+         *     mult       -> (in) The limb to be multiplied by.
+         *     ret        -> (out) The limb array where the lower <len1> limbs of the result will be stored in. It may
+         *                    be the same array as <cand1>.
+         *
+         * Returns:
+         *     _ret       -> The leading limb of the result, which does not fit into <ret>.
+         */
+        static limb_t limbMultiplicationNoCopy(const limb_t* cand1, int len1, limb_t mult, limb_t* ret);
+
+        /*
+         * Multiplies a limb array by a single limb and adds the result into another one.
+         *
+         * Params:
+         *     cand1      -> (in) The value of the limb array.
+         *     len1       -> (in) Length of <cand1> in limbs.
+         *     mult       -> (in) The limb to be multiplied by.
+         *     ret        -> (in/out) The limb array with it's lower <len1> limbs added by the result.
+         *
+         * Returns:
+         *     _ret       -> The carry out of the <len1> limbs of <ret>.
+         */
+        static limb_t limbMultiplyAddNoCopy(const limb_t* cand1, int len1, limb_t mult, limb_t* ret);
+
+        /*
+         * Multiplies a limb array by a single limb and subtracts the result from another one.
+         *
+         * Params:
+         *     cand1      -> (in) The value of the limb array.
+         *     len1       -> (in) Length of <cand1> in limbs.
+         *     mult       -> (in) The limb to be multiplied by.
+         *     ret        -> (in/out) The limb array with it's lower <len1> limbs subtracted by the result.
+         *
+         * Returns:
+         *     _ret       -> The borrow out of the <len1> limbs of <ret>.
+         */
+        static limb_t limbMultiplySubtractNoCopy(const limb_t* cand1, int len1, limb_t mult, limb_t* ret);
+
+        /*
+         * Divides a limb array by a single limb and stores the quotient into another one. Each quotient limb
+         *  takes two multiplications with a precomputed reciprocal of the divisor, instead of a hardware division.
+         *
+         * Params:
+         *     cand1      -> (in) The value of the limb array.
+         *     len1       -> (in) Length of <cand1> in limbs.
+         *     divi       -> (in) The limb to be divided by, which MUST NOT be zero.
+         *     ret        -> (out) The limb array where the quotient will be stored in, with it's length equals to
+         *                    <len1>. It MAY be the same as <cand1>, or nullptr if only the remainder is needed.
+         *
+         * Returns:
+         *     _ret       -> The remainder.
+         */
+        static limb_t limbDivisionNoCopy(const limb_t* cand1, int len1, limb_t divi, limb_t* ret);
+
+        /*
+         * Compares two limb arrays of possibly different lengths, leading zeros allowed.
+         *
+         * Params:
+         *     cand1      -> (in) The value of the first candidate.
+         *     len1       -> (in) Length of <cand1> in limbs.
+         *     cand2      -> (in) The value of the second candidate.
+         *     len2       -> (in) Length of <cand2> in limbs.
+         *
+         * Returns:
+         *     _ret       -> 1 if the first candidate is greater, -1 if it's less, or 0 if they are equal.
+         */
+        static int limbWiseCompare(const limb_t* cand1, int len1, const limb_t* cand2, int len2);
+
         /*
-         * Divides the third byte array by the first one and stores the result in the second one.
+         * Divides the third limb array by the first one and stores the result in the second one, one quotient
+         *  limb at a time by Knuth's Algorithm D.
          *
          * Params:
-         *     divi        -> (in) The value of the divisor.
-         *     diviLen     -> (in) Length of <divi> in bytes. [<diviLen> + <qLen> - 1] MUST BE THE LENGTH OF THE <remain>!
+         *     divi        -> (in) The value of the divisor, which MUST NOT be zero.
+         *     diviLen     -> (in) Length of <divi> in limbs. [<diviLen> + <qLen>] MUST BE THE LENGTH OF THE <remain>!
          *     quotient    -> (out) The value of the quotient.
-         *     qLen        -> (in) Length of <quotient> in bytes. [<diviLen> + <qLen> - 1] MUST BE THE LENGTH OF THE <remain>!
+         *     qLen        -> (in) Length of <quotient> in limbs. [<diviLen> + <qLen>] MUST BE THE LENGTH OF THE <remain>!
          *     remain      -> (in/out) Passed into the function as the dividend, and stores the remainder when the function returns.
+         *                     The dividend MUST be less than [<divi> * 2^(64 * <qLen>)].
          */
-        static void divisionUtil(const unsigned char* divi, int diviLen, unsigned char* quotient, int qLen, unsigned char* remain);
+        static void divisionUtil(const limb_t* divi, int diviLen, limb_t* quotient, int qLen, limb_t* remain);
+
+        /*
+         * Divides the third limb array by the first one and stores the result in the second one by Knuth's
+         *  Algorithm D, without normalization.
+         *
+         * Params:
+         *     divi        -> (in) The value of the divisor, whose top limb MUST have it's highest bit set.
+         *     diviLen     -> (in) Length of <divi> in limbs. [<diviLen> + <qLen>] MUST BE THE LENGTH OF THE <remain>!
+         *     quotient    -> (out) The value of the quotient.
+         *     qLen        -> (in) Length of <quotient> in limbs. [<diviLen> + <qLen>] MUST BE THE LENGTH OF THE <remain>!
+         *     remain      -> (in/out) Passed into the function as the dividend, and stores the remainder when the function returns.
+         *                     The dividend MUST be less than [<divi> * 2^(64 * <qLen>)].
+         */
+        static void schoolbookDivisionNoCopy(const limb_t* divi, int diviLen, limb_t* quotient, int qLen, limb_t* remain);
+
+        /*
+         * Divides the third limb array by the first one and stores the result in the second one by recursively
+         *  splitting the quotient in halves, whose remainders are fixed up by multiplications. Divisors shorter
+         *  than RECURSIVE_DIVISION_THRESHOLD are handed to schoolbookDivisionNoCopy().
+         *
+         * Params:
+         *     divi        -> (in) The value of the divisor, whose top limb MUST have it's highest bit set.
+         *     diviLen     -> (in) Length of <divi> in limbs, which MUST NOT be less than <qLen>.
+         *     quotient    -> (out) The lower <qLen> limbs of the quotient.
+         *     qLen        -> (in) Length of <quotient> in limbs, which MUST be positive.
+         *     remain      -> (in/out) Passed into the function as the dividend, and stores the remainder when the function returns.
+         *                     It's length MUST be [<diviLen> + <qLen>].
+         *
+         * Returns:
+         *     _ret        -> The top limb of the quotient, which is either 0 or 1.
+         */
+        static limb_t recursiveDivisionNoCopy(const limb_t* divi, int diviLen, limb_t* quotient, int qLen, limb_t* remain);
         
         /*
          * Divides this BigInt by the divisor and returns either the quotient or the remainder.
          *
          * Params:
          *     divi        -> (in) The divisor.
-         *     bLenOut     -> (out) Length of the returned char array in bytes. This will be automatically calculated.
+         *     outLen      -> (out) Length of the returned limb array. This will be automatically calculated.
          *     q_than_r    -> (out) Whether the function returns the quotient or the remainder.
          *                      true  : returns the quotient;
          *                      false : returns the remainder.
          *
          * Returns:
-         *     _ret        -> The byte array where the result is stored in, with it's length equals to <bLenOut>.
+         *     _ret        -> The limb array where the result is stored in, with it's length equals to <outLen>.
+         */
+		limb_t* divisionUtil(const BigInt& divi, int& outLen, bool q_than_r) const;
+        
+        /*
+         * Divides this BigInt by the divisor and returns both the quotient and the remainder from a single division.
+         *
+         * Params:
+         *     divi        -> (in) The divisor.
+         *     quotient    -> (out) The limb array where the quotient is stored in, or nullptr if it's zero.
+         *     qLen        -> (out) Length of <quotient>.
+         *     remain      -> (out) The limb array where the remainder is stored in.
+         *     rLen        -> (out) Length of <remain>.
+         */
+		void divisionUtil(const BigInt& divi, limb_t*& quotient, int& qLen, limb_t*& remain, int& rLen) const;
+
+        /*
+         * Returns 10^(19 * 2^level) as a limb array. The powers are computed by repeated squaring once and
+         *  kept in a cache of the calling thread, which owns the returned pointer.
+         *
+         * Params:
+         *     level       -> (in) The level of the power, which MUST be less than 32.
+         *     len         -> (out) Length of the returned limb array.
+         *
+         * Returns:
+         *     _ret        -> The limb array where the power is stored in, with it's length equals to <len>.
+         */
+        static const limb_t* tenPowerUtil(int level, int& len);
+
+        /*
+         * Writes the decimal digits of a limb array, zero padded to the specified count. Long values are split
+         *  in halves by the cached powers of ten recursively, and the short ones are divided by 10^19 repeatedly.
+         *
+         * Params:
+         *     num         -> (in) The value of the limb array, which MUST be less than 10^<outLen>.
+         *     len         -> (in) Length of <num> in limbs.
+         *     out         -> (out) Where the digits are written, without a null character.
+         *     outLen      -> (in) Number of digits to be written, which MUST be 19 times a power of two.
+         */
+        static void decimalStringUtil(const limb_t* num, int len, char* out, int outLen);
+
+        /*
+         * Puts the value of 19-digit decimal chunks together into a limb array. Long runs of chunks are split
+         *  at a power of two recursively and joined by multiplying with the cached powers of ten.
+         *
+         * Params:
+         *     chunks      -> (in) The chunks, each of which is less than 10^19, from the least significant one.
+         *     count       -> (in) Number of the chunks, which MUST be positive.
+         *     ret         -> (out) The limb array where the value will be stored in, with it's length equals to <count>.
          */
-		unsigned char* divisionUtil(const BigInt& divi, int& bOutLen, bool q_than_r) const;
+        static void decimalParseUtil(const limb_t* chunks, int count, limb_t* ret);
         
         /*
-         * Whether the first byte array is greater in value than the second one.
+         * Whether the first limb array is greater in value than the second one.
          *
          * Params:
          *     cand1      -> (in) The value of the first candidate.
          *     cand2      -> (in) The value of the second candidate.
-         *     len        -> (in) Length of both <cand1> and <cand2> in bytes.
-         *     equal      -> (in/out) The bool value returned when two byte arrays are equal in values.
+         *     len        -> (in) Length of both <cand1> and <cand2> in limbs.
+         *     equal      -> (in/out) The bool value returned when two limb arrays are equal in values.
          *
          * Returns:
          *     _ret       -> Whether the first candidate is greater than the second one, or <equal>.
          */
-        static bool byteWiseGreater(const unsigned char* cand1, const unsigned char* cand2, int len, bool equal);
+        static bool limbWiseGreater(const limb_t* cand1, const limb_t* cand2, int len, bool equal);
         
         /*
          * Whether this BigInt is greater than the input one in absolute value.
@@ -207,46 +724,221 @@ class BigInt
         bool absGreater(const BigInt& comp) const;
         
         /*
-         * Creates a array of char arrays storing the values of TENs left-shifted by 0 to 7 bits.
-         *  The result is used in generating decimal string output.
+         * Creates a limb array, which may be used to create a BigInt object, storing the value parsed from a decimal string.
+         *
+         * Params:
+         *     decimalString    -> (in) The string represents the number in decimal.
+         *     len              -> (in) Length of the input string.
+         *     isNeg            -> (out) Whether the returned value should be negative.
+         *     retLen           -> (out) Length of the returned limb array.
+         *
+         * Returns:
+         *     _ret             -> The limb array storing the binary value of the input decimal string.
+         */
+        static limb_t* createFromDecimal(const char* decimalString, int len, bool& isNeg, int& retLen);
+        
+        /*
+         * Allocate a chunk of memory of certain length and fill it with zeros.
+         *
+         * Param:
+         *     _len    -> (in) Length in limbs of the memory to be allocated.
+         *
+         * Returns:
+         *     _ret    -> The limb array with the length <_len> filled with zeros.
+         */
+        static limb_t* allocZerosMem(int _len);
+        
+        /*
+         * Takes a limb array from the installed allocator. The array remembers where it came from, so
+         *  it MUST be freed with freeLimbArray().
+         *
+         * Param:
+         *     _len    -> (in) Length in limbs of the array.
+         *
+         * Returns:
+         *     _ret    -> The limb array with the length <_len>, which is NOT zeroed.
+         */
+        static limb_t* allocLimbArray(int _len);
+        
+        /*
+         * Gives a limb array from allocLimbArray() back to the allocator it came from.
+         *
+         * Param:
+         *     num     -> (in) The limb array to be freed, or nullptr.
+         */
+        static void freeLimbArray(limb_t* num);
+        
+        /*
+         * Whether a single limb is a prime, by trial division for small values and a deterministic
+         *  Miller-Rabin test with the first 12 primes as the bases otherwise.
+         *
+         * Param:
+         *     n       -> (in) The value to be tested.
+         *
+         * Returns:
+         *     _ret    -> Whether <n> is a prime.
+         */
+        static bool primeLimbUtil(limb_t n);
+        
+        /*
+         * Whether the absolute value of this BigInt has a small odd prime factor (below 65536 by default, and
+         *  fewer of them for short values), found from it's remainders modulo the prime groups by the product
+         *  tree. The value MUST be longer than a limb, so that it's not one of those primes itself.
          *
          * Returns:
-         *     _ret    -> The returned values are listed below:
-         *                  [0] -> 10 << 0, 2 bytes in length.
-         *                  [1] -> 10 << 1, 2 bytes in length.
-         *                  [2] -> 10 << 2, 2 bytes in length.
-         *                  [3] -> 10 << 3, 2 bytes in length.
-         *                  [4] -> 10 << 4, 2 bytes in length.
-         *                  [5] -> 10 << 5, 2 bytes in length.
-         *                  [6] -> 10 << 6, 2 bytes in length.
-         *                  [7] -> 10 << 7, 2 bytes in length.
+         *     _ret    -> Whether a factor is found.
          */
-        static unsigned char** CREATE_TENS();
+        bool trialDivisionUtil() const;
         
         /*
-         * Creates a byte array, which may be used to create a BigInt object, storing the value parsed from a decimal string.
+         * Returns a level of the product tree of the small odd primes. The primes are grouped in order into
+         *  products which fit into a limb, which make the level 0, and each node of a level above is the
+         *  product of two adjacent nodes below it. The tree is built once and kept in a cache of the calling
+         *  thread, which owns the returned pointer.
          *
          * Params:
-         *     decimalString    -> (in) The string represents the number in decimal.
-         *     len              -> (in) Length of the input string.
-         *     isNeg            -> (out) Whether the returned value should be negative.
-         *     retLen           -> (out) Length of the returned byte array.
+         *     level       -> (in) The level, which MUST NOT be above the top one (the one with a single node).
+         *     count       -> (out) Number of nodes of the level.
          *
          * Returns:
-         *     _ret             -> The byte array storing the binary value of the input decimal string.
+         *     _ret        -> The nodes, each of which takes 2^<level> limbs (with leading zeros if shorter),
+         *                     or nullptr if <level> is above the top.
          */
-        static unsigned char* createFromDecimal(const char* decimalString, int len, bool& isNeg, int& retLen);
+        static const limb_t* primeTreeUtil(int level, int& count);
         
         /*
-         * Allocate a chunk of memory of certain length and fill it with zeros.
+         * Reduces a value modulo every prime group under a node of the prime product tree, from the node down
+         *  to the groups. The value is divided only by the nodes shorter than it, so that a short value skips
+         *  the top of the tree.
+         *
+         * Params:
+         *     num         -> (in) The value to be reduced.
+         *     len         -> (in) Length of <num> without the leading zero(s).
+         *     level       -> (in) The level of the node.
+         *     index       -> (in) The index of the node in it's level.
+         *     remainders  -> (out) The remainder modulo each group, indexed by the group.
+         */
+        static void remainderTreeUtil(const limb_t* num, int len, int level, int index, limb_t* remainders);
+        
+        /*
+         * The strong probable prime (Miller-Rabin) test of the modulus of a Montgomery context to a base.
+         *
+         * Params:
+         *     context    -> (in) The context of the value to be tested, which MUST be odd and greater than 3.
+         *     base       -> (in) The base, in [2, <modulus> - 2].
+         *
+         * Returns:
+         *     _ret       -> Whether the value is a strong probable prime to the base.
+         */
+        static bool millerRabinUtil(const BigIntMontgomery& context, const BigInt& base);
+        
+        /*
+         * The strong Lucas probable prime test of the modulus of a Montgomery context, with the parameters
+         *  chosen by Selfridge's method A (P = 1, and D the first of 5, -7, 9, -11, ... with (D / n) = -1).
          *
          * Param:
-         *     _len    -> (in) Length in bytes of the memory to be allocated.
+         *     context    -> (in) The context of the value to be tested, which MUST be odd and greater than 3.
+         *
+         * Returns:
+         *     _ret       -> Whether the value is a strong Lucas probable prime.
+         */
+        static bool lucasUtil(const BigIntMontgomery& context);
+        
+        /*
+         * The integer k-th root of a positive value by Newton's iteration from above. The starting value
+         *  comes from the root of the upper part of the value (found the same way), so that one step of the
+         *  iteration is mostly enough at each size, and the result is confirmed by it's k-th power.
+         *
+         * Params:
+         *     n           -> (in) The value, which MUST be positive.
+         *     k           -> (in) The degree of the root, which MUST be at least 2.
+         *
+         * Returns:
+         *     _ret        -> The largest integer whose k-th power is not greater than <n>.
+         */
+        static BigInt rootUtil(const BigInt& n, int k);
+        
+        /*
+         * Runs Euclid's algorithm on the leading bits of two values (Lehmer's method) for as long as the
+         *  quotients are sure to be the same as the ones of the whole values, by Jebelean's condition.
+         *
+         * Params:
+         *     a           -> (in) The larger value, which MUST be positive.
+         *     b           -> (in) The smaller value, which MUST NOT be negative.
+         *     matrix      -> (out) The cofactors {A, B, C, D} of the steps, each below 2^31.
+         *
+         * Returns:
+         *     _ret        -> Number of the steps taken, which may be 0. See lehmerApplyUtil() for the use.
+         */
+        static int lehmerMatrixUtil(const BigInt& a, const BigInt& b, limb_t* matrix);
+        
+        /*
+         * Applies the steps found by lehmerMatrixUtil() to a pair of values, which are replaced by
+         *  (A * x - B * y, D * y - C * x) after an even number of steps, or (A * y - B * x, D * x - C * y)
+         *  after an odd one.
+         *
+         * Params:
+         *     x           -> (in/out) The first value of the pair.
+         *     y           -> (in/out) The second value of the pair.
+         *     matrix      -> (in) The cofactors from lehmerMatrixUtil().
+         *     steps       -> (in) The number of the steps from lehmerMatrixUtil().
+         *     t           -> (in) A BigInt to be used as scratch space, whose value is lost.
+         *     u           -> (in) Another one.
+         */
+        static void lehmerApplyUtil(BigInt& x, BigInt& y, const limb_t* matrix, int steps, BigInt& t, BigInt& u);
+        
+        /*
+         * One step of Euclid's algorithm, (a, b) -> (b, a mod b), which is applied to pairs of values along
+         *  with it as (x, y) -> (y, x - q * y) for the quotient q.
+         *
+         * Params:
+         *     a           -> (in/out) The larger value, which MUST be positive.
+         *     b           -> (in/out) The smaller value, which MUST be positive.
+         *     pairs       -> (in/out) The pairs, as <pairs>[2 * i] and <pairs>[2 * i + 1], or nullptr.
+         *     pairCount   -> (in) Number of the pairs.
+         */
+        static void euclidStepUtil(BigInt& a, BigInt& b, BigInt* pairs, int pairCount);
+        
+        /*
+         * Replaces (a, b) with (n00 * a + n01 * b, n10 * a + n11 * b) if it makes the larger of them less
+         *  than <a>. A negative result is negated along with it's row of the matrix, and the two are
+         *  swapped (along with the rows) if the first one is the smaller.
+         *
+         * Params:
+         *     a           -> (in/out) The larger value.
+         *     b           -> (in/out) The smaller value.
+         *     n           -> (in/out) The matrix by columns, as {n00, n10, n01, n11}.
          *
          * Returns:
-         *     _ret    -> The byte array with the length <_len> filled with zeros.
+         *     _ret        -> Whether the values are replaced.
+         */
+        static bool matrixApplyUtil(BigInt& a, BigInt& b, BigInt* n);
+        
+        /*
+         * Reduces two values of m limbs by Euclid's algorithm until the smaller one has at most (m / 2 + 1)
+         *  limbs, and gives the matrix of the reduction. Above HALF_GCD_THRESHOLD, the matrix is found by
+         *  recursing on the upper halves twice (the half-GCD), and by Lehmer's steps otherwise.
+         *
+         * Params:
+         *     a           -> (in/out) The larger value, which MUST be positive.
+         *     b           -> (in/out) The smaller value, which MUST NOT be negative.
+         *     n           -> (out) The matrix by columns, as {n00, n10, n01, n11}, so that the values left
+         *                     are (n00 * a + n01 * b, n10 * a + n11 * b) of the ones passed in.
+         */
+        static void halfGcdUtil(BigInt& a, BigInt& b, BigInt* n);
+        
+        /*
+         * Finds the greatest common divisor by the half-GCD, Lehmer's steps or the binary method depending
+         *  on the length, and follows the coefficients of Bezout's identity if asked to.
+         *
+         * Params:
+         *     a           -> (in/out) The larger value, which MUST be positive. It becomes the GCD.
+         *     b           -> (in/out) The smaller value, which MUST NOT be negative. It becomes 0.
+         *     cofactors   -> (in/out) A pair which goes through the same steps as the values, or nullptr.
+         *                     The first of it becomes the coefficient of <a> in the GCD if it's {1, 0},
+         *                     or the one of <b> if it's {0, 1}.
          */
-        static unsigned char* allocZerosMem(int _len);
+        static void gcdUtil(BigInt& a, BigInt& b, BigInt* cofactors);
     
     /*
      * THESE METHODS ARE AVAILABLE FOR PUBLIC USES.
@@ -285,27 +977,101 @@ class BigInt
     	 */
         BigInt(const BigInt& copyFrom);
         
+    	/*
+    	 * Moves a BigInt from another (temporary) BigInt, taking over it's content without copying.
+    	 *  The moved-from BigInt is left as zero.
+    	 *
+    	 * Param:
+    	 *     moveFrom    -> (in/out) The BigInt to be moved.
+    	 */
+        BigInt(BigInt&& moveFrom);
+        
         /*
          * Destructor.
          */
         ~BigInt();
         
+        /*
+         * Returns the length in bytes of the array returned by getRawBytes().
+         */
         int getByteLength() const;
+        
+        /*
+         * Makes room for values up to the given length in bytes, so that the compound assignments
+         *  (+=, -=, *= and so on) don't have to reallocate until the value grows past it. The value
+         *  of this BigInt is not changed.
+         *
+         * Params:
+         *     byteLength  -> (in) The length in bytes to make room for.
+         */
+        void reserve(int byteLength);
 
         /*
          * Set the value of this BigInt to be same as the input one and returns the new value.
          *  The returned value MAY NOT be set to any other value(s).
          *
          * Usage:
-         *     <varName1> = <varName2>
+         *     <varName1> = <varName2>
+         *
+         * Param:
+         *     copyFrom    -> (in) The value to be copied from.
+         *
+         * Returns:
+         *     _ret        -> The value of this BigInt after setting the value to the new one.
+         */
+        const BigInt& operator=(const BigInt& copyFrom);
+        
+        /*
+         * Set the value of this BigInt by taking over the content of a temporary one without copying,
+         *  and returns the new value. The moved-from BigInt is left as zero.
+         *
+         * Param:
+         *     moveFrom    -> (in/out) The value to be moved from.
+         *
+         * Returns:
+         *     _ret        -> The value of this BigInt after setting the value to the new one.
+         */
+        const BigInt& operator=(BigInt&& moveFrom);
+        
+        /*
+         * Wraps a BigInt so that the operators (+, - and *) applied to it capture the expression
+         *  instead of computing it. The expression is evaluated in one pass when it's assigned to
+         *  (or added to, or subtracted from) a BigInt, with the products accumulated into the
+         *  destination and no BigInt created for the intermediate values.
+         *
+         *  Each product needs at least one wrapped operand, or it's computed eagerly as usual. The
+         *  expression keeps references to it's operands, so it MUST be evaluated in the statement
+         *  it's written in.
+         *
+         * Usage:
+         *     <varName> = BigInt::lazy(a) * b + BigInt::lazy(c) * d - e
+         *     <varName> += BigInt::lazy(a) * b
          *
          * Param:
-         *     copyFrom    -> (in) The value to be copied from.
+         *     value       -> (in) The BigInt to be wrapped.
          *
          * Returns:
-         *     _ret        -> The value of this BigInt after setting the value to the new one.
+         *     _ret        -> The expression holding <value>.
          */
-        const BigInt& operator=(const BigInt& copyFrom);
+        static BigIntRef lazy(const BigInt& value);
+        
+        /*
+         * Creates a BigInt with the value of a lazy expression, see BigInt::lazy().
+         */
+        template<class E> BigInt(const BigIntExpression<E>& expr);
+        
+        /*
+         * Sets the value of this BigInt to the value of a lazy expression, which MAY refer to this
+         *  BigInt, see BigInt::lazy(). The returned value MAY NOT be set to any other value(s).
+         */
+        template<class E> const BigInt& operator=(const BigIntExpression<E>& expr);
+        
+        /*
+         * Adds (or subtracts) the value of a lazy expression to this BigInt, see BigInt::lazy(). The
+         *  returned value MAY NOT be set to any other value(s).
+         */
+        template<class E> const BigInt& operator+=(const BigIntExpression<E>& expr);
+        template<class E> const BigInt& operator-=(const BigIntExpression<E>& expr);
         
         /*
          * Returns the opposite number of this BigInt. The returned value MAY NOT be set to any
@@ -317,7 +1083,8 @@ class BigInt
          * Returns:
          *     _ret        -> The opposite number of this BigInt.
          */
-        const BigInt operator-() const;
+        BigInt operator-() const &;
+        BigInt operator-() &&;
         
         /*
          * Returns the absolute number of this BigInt. The returned value MAY NOT be set to any
@@ -326,7 +1093,7 @@ class BigInt
          * Returns:
          *     _ret        -> The absolute number of this BigInt.
          */
-        const BigInt abs() const;
+        BigInt abs() const;
         
         /*
          * Returns the summation of this BigInt and the input one. The returned value MAY NOT be
@@ -341,7 +1108,15 @@ class BigInt
          * Returns:
          *     _ret    -> The summation of the two BigInts.
          */
-        const BigInt operator+(const BigInt& addi) const;
+        BigInt operator+(const BigInt& addi) const &;
+        
+        /*
+         * Same as above, but a temporary operand is reused to hold the summation, so that
+		 *  chained expressions like "a + b + c" do not allocate for every operator.
+         */
+        BigInt operator+(const BigInt& addi) &&;
+        BigInt operator+(BigInt&& addi) const &;
+        BigInt operator+(BigInt&& addi) &&;
         
         /*
          * Returns the signed difference of this BigInt and the input one. The returned value
@@ -356,7 +1131,14 @@ class BigInt
          * Returns:
          *     _ret    -> The signed difference of the two BigInts.
          */
-        const BigInt operator-(const BigInt& nega) const;
+        BigInt operator-(const BigInt& nega) const &;
+        
+        /*
+         * Same as above, but a temporary operand is reused to hold the difference.
+         */
+        BigInt operator-(const BigInt& nega) &&;
+        BigInt operator-(BigInt&& nega) const &;
+        BigInt operator-(BigInt&& nega) &&;
         
         /*
          * Returns the product of this BigInt and the input one. The returned value MAY NOT be
@@ -371,7 +1153,7 @@ class BigInt
          * Returns:
          *     _ret    -> The product of the two BigInts.
          */
-        const BigInt operator*(const BigInt& mult) const;
+        BigInt operator*(const BigInt& mult) const;
         
         /*
          * Returns the quotient of this BigInt divided by the input one. The returned value MAY
@@ -386,7 +1168,7 @@ class BigInt
          * Returns:
          *     _ret    -> The quotient of this BigInt divided by the input one.
          */
-        const BigInt operator/(const BigInt& divi) const;
+        BigInt operator/(const BigInt& divi) const;
         
         /*
          * Returns the remainder of this BigInt divided by the input one. The returned value MAY
@@ -401,7 +1183,7 @@ class BigInt
          * Returns:
          *     _ret    -> The remainder of this BigInt divided by the input one.
          */
-        const BigInt operator%(const BigInt& divi) const;
+        BigInt operator%(const BigInt& divi) const;
         
         /*
          * Increases this BigInt by 1 and returns this BigInt after the operation. The returned
@@ -524,6 +1306,34 @@ class BigInt
          */
         const BigInt& operator%=(const BigInt& divi);
         
+        /*
+         * Adds the product of two values to this BigInt and returns the new value, without creating
+         *  the product. A single-limb factor is multiplied and added in one pass over the limbs. The
+         *  returned value MAY NOT be set to any other value(s).
+         *
+         * Usage:
+         *     <varName>.addmul(<varName1>, <varName2>)    ( === <varName> += <varName1> * <varName2> )
+         *
+         * Params:
+         *     mult1       -> (in) The first factor. It MAY be this BigInt.
+         *     mult2       -> (in) The second factor. It MAY be this BigInt.
+         *
+         * Returns:
+         *     _ret        -> The result of this operation.
+         */
+        const BigInt& addmul(const BigInt& mult1, const BigInt& mult2);
+        const BigInt& addmul(const BigInt& mult1, long long mult2);
+        
+        /*
+         * Subtracts the product of two values from this BigInt and returns the new value. Please
+         *  see addmul() above.
+         *
+         * Usage:
+         *     <varName>.submul(<varName1>, <varName2>)    ( === <varName> -= <varName1> * <varName2> )
+         */
+        const BigInt& submul(const BigInt& mult1, const BigInt& mult2);
+        const BigInt& submul(const BigInt& mult1, long long mult2);
+        
         /*
          * Compares if the value of two BigInts are equal.
          *
@@ -612,7 +1422,7 @@ class BigInt
          * Returns:
          *     _ret    -> result of this operation.
          */
-        const BigInt operator<<(const int bits) const;
+        BigInt operator<<(const int bits) const;
         
         /*
          * Returns the value of this BigInt right-shifted by certain bits. The returned value
@@ -624,7 +1434,7 @@ class BigInt
          * Returns:
          *     _ret    -> result of this operation.
          */
-        const BigInt operator>>(const int bits) const;
+        BigInt operator>>(const int bits) const;
         
         // Not implemented yet. :(
         const BigInt& operator<<=(const int bits);
@@ -633,14 +1443,19 @@ class BigInt
         const BigInt& operator>>=(const int bits);
         
         /*
-         * Returns the certain digit of this BigInt represented in decimal.
+         * Returns the certain digit of this BigInt represented in decimal. The digits are
+		 *  converted once and cached until the value changes, so reading through all of
+		 *  them takes a single conversion.
+         *
+         * WARNING: Since the cache is built inside, reading digits of the same BigInt from
+		 *  multiple threads at once is NOT safe.
          *
          * Usage:
          *     <varName>[<index>]
          *
          * Returns:
          *     _ret    -> The <index>-th digit (from right to left, starting from 0) of this
-		 *                 BigInt represented in decimal.
+		 *                 BigInt represented in decimal, or -1 if there is no such digit.
          */
         short operator[](const int index) const;
         
@@ -653,7 +1468,74 @@ class BigInt
 		 * Returns:
 		 *     _ret    -> The square of this BigInt.
          */
-        const BigInt square() const;
+        BigInt square() const;
+        
+        /*
+         * Returns this BigInt to the power of <exp> modulo <mod>, which is in [0, <mod>). Odd moduli are
+         *  handled in Montgomery form, see BigIntMontgomery. The returned value MAY NOT be set to any
+         *  other value(s).
+         *
+         * Params:
+         *     exp     -> (in) The exponent, which MUST NOT be negative.
+         *     mod     -> (in) The modulus, which MUST be positive.
+         *
+         * Returns:
+         *     _ret    -> (this ^ exp) mod <mod>.
+         */
+        BigInt modPow(const BigInt& exp, const BigInt& mod) const;
+        
+        /*
+         * Returns the greatest common divisor of the absolute values of this BigInt and the input one,
+         *  which is 0 only if both are 0.
+         */
+        BigInt gcd(const BigInt& other) const;
+        
+        /*
+         * Returns the greatest common divisor of this BigInt and the input one like gcd(), along with the
+		 *  coefficients of Bezout's identity.
+		 *
+		 * Params:
+		 *     other   -> (in) The other value.
+		 *     x       -> (out) The coefficient of this BigInt.
+		 *     y       -> (out) The coefficient of <other>, so that this * x + other * y = GCD.
+		 *
+		 * Returns:
+		 *     _ret    -> The greatest common divisor.
+         */
+        BigInt extendedGcd(const BigInt& other, BigInt& x, BigInt& y) const;
+        
+        /*
+         * Returns the inverse of this BigInt modulo <mod>, which is in [0, <mod>).
+		 *
+		 * Param:
+		 *     mod     -> (in) The modulus, which MUST be positive.
+		 *
+		 * Returns:
+		 *     _ret    -> The value x with (this * x) mod <mod> = 1, or 0 if there's none (when this
+		 *                 BigInt and <mod> have a common factor).
+         */
+        BigInt modInverse(const BigInt& mod) const;
+        
+        /*
+         * Divides this BigInt by the input one and gives both the quotient and the remainder from
+		 *  a single division. The quotient is truncated toward zero and the remainder has the sign
+		 *  of this BigInt, just like "/" and "%".
+		 *
+		 * Params:
+		 *     divi        -> (in) The divisor.
+		 *     quotient    -> (out) The quotient. It MAY be the same object as this BigInt or <divi>.
+		 *     remain      -> (out) The remainder. It MAY be the same object as this BigInt or <divi>,
+		 *                    but NOT the same as <quotient>.
+         */
+        void divmod(const BigInt& divi, BigInt& quotient, BigInt& remain) const;
+        void divmod(const int& divi, BigInt& quotient, int& remain) const;
+        
+        /*
+         * Same as divmod(), except that the quotient is rounded toward negative infinity and the
+		 *  remainder has the sign of the divisor (or is zero).
+         */
+        void floorDivmod(const BigInt& divi, BigInt& quotient, BigInt& remain) const;
+        void floorDivmod(const int& divi, BigInt& quotient, int& remain) const;
         
         /*
          * Returns the integer-square-root of this BigInt. The returned value MAY NOT be set
@@ -667,18 +1549,75 @@ class BigInt
 		 *                           is false and this BigInt is negative, the value of 0 is
 		 *                           returned.
          */
-        const BigInt sqrt(bool ignoreNegative = false) const;
+        BigInt sqrt(bool ignoreNegative = false) const;
         
         /*
-         * Returns whether this BigInt is a prime.
-         *
-         * WARNING: TIME INEFFICIENT! This costs A LOT OF time if the value is large! (Cracking RSA?)
+         * Returns the integer k-th root of this BigInt, rounded toward zero.
+		 *
+		 * Param:
+		 *     k       -> (in) The degree of the root.
+		 *
+		 * Returns:
+		 *     _ret    -> The k-th root. If <k> is less than 1, or if this BigInt is negative and <k> is
+		 *                 even, the value of 0 is returned.
+         */
+        BigInt nthRoot(int k) const;
+        
+        /*
+         * Returns whether this BigInt is a perfect power, that is b^e for an integer b and an e of at
+		 *  least 2. 0, 1 and -1 are taken as ones, with e = 2 (3 for -1) and b = itself.
+		 *
+		 * Params:
+		 *     base    -> (out) The base b, for the largest e.
+		 *     exp     -> (out) The largest e, which is odd for a negative BigInt.
+		 *
+		 * Returns:
+		 *     _ret    -> Whether this BigInt is a perfect power. <base> and <exp> are left as they are
+		 *                 if it's not.
+         */
+        bool isPerfectPower(BigInt& base, int& exp) const;
+        
+        bool isPerfectPower() const;
+        
+        /*
+         * Returns whether the absolute value of this BigInt is a prime. It's the Baillie-PSW test after
+         *  trial division by the small primes, that is a Miller-Rabin test to the base 2 followed by a
+         *  strong Lucas test. It's exact for values below 2^64, and no composite passing it is known
+         *  above that.
 		 *
 		 * Returns:
 		 *     _ret    -> Whether this BigInt is a prime.
          */
         bool isPrime() const;
         
+        /*
+         * Returns whether the absolute value of this BigInt is probably a prime, by trial division by the
+         *  small primes and Miller-Rabin tests to <rounds> bases. It's exact for values below 2^64.
+         *
+         * The bases are 2 and pseudo-random ones derived from the value itself, so the same value always
+         *  gets the same answer. They aren't random, so no bound on the chance of a composite passing is
+         *  promised, and a composite crafted against them MAY pass.
+		 *
+		 * Param:
+		 *     rounds    -> (in) Number of the bases to be tested. At least one (base 2) is always tested.
+		 *
+		 * Returns:
+		 *     _ret      -> Whether this BigInt is probably a prime.
+         */
+        bool isProbablePrime(int rounds = 25) const;
+        
+        /*
+         * Returns the smallest prime greater than this BigInt (2 if it's less than 2). The candidates are
+         *  sieved by the small primes and the survivors go through the test of isPrime().
+         */
+        BigInt nextPrime() const;
+        
+        /*
+         * Returns the largest prime less than this BigInt, or 0 if there's none. The candidates are
+         *  sieved by the small primes and the survivors go through the test of isPrime().
+         */
+        BigInt prevPrime() const;
+        
         /*
          * Returns the signed hexadecimal representation of this BigInt.
 		 *
@@ -758,12 +1697,23 @@ class BigInt
          *
          * Please use pure BigInt operations for efficiency!
          */
-        const BigInt operator+(const int& addi) const;
-        const BigInt operator-(const int& nega) const;
-        const BigInt operator*(const int& mult) const;
-        const BigInt operator/(const int& divi) const;
-        const BigInt operator%(const int& divi) const;
+        BigInt operator+(const int& addi) const &;
+        BigInt operator+(const int& addi) &&;
+        BigInt operator-(const int& nega) const &;
+        BigInt operator-(const int& nega) &&;
+        BigInt operator*(const int& mult) const;
+        
+        /*
+         * Divides this BigInt by an int in a single pass, without converting the divisor into a BigInt.
+         *  The quotient is truncated toward zero, and the remainder has the sign of this BigInt.
+         */
+        BigInt operator/(const int& divi) const;
+        BigInt operator%(const int& divi) const;
 
+        /*
+         * Returns the absolute value of this BigInt as a little-endian byte array, whose length
+         *  is given by getByteLength(). The pointer is owned by this BigInt.
+         */
         const unsigned char *getRawBytes() const;
 };
 
@@ -772,10 +1722,381 @@ class BigInt
  *
  * Please use pure BigInt operations for efficiency!
  */
-const BigInt operator+(const int& addi, const BigInt& _this);
-const BigInt operator-(const int& nega, const BigInt& _this);
-const BigInt operator*(const int& mult, const BigInt& _this);
-const BigInt operator/(const int& divi, const BigInt& _this);
-const BigInt operator%(const int& divi, const BigInt& _this);
+BigInt operator+(const int& addi, const BigInt& _this);
+BigInt operator-(const int& nega, const BigInt& _this);
+BigInt operator*(const int& mult, const BigInt& _this);
+BigInt operator/(const int& divi, const BigInt& _this);
+BigInt operator%(const int& divi, const BigInt& _this);
+
+/*
+ * Modular arithmetic with a fixed odd modulus m in Montgomery form, where a value x is kept as
+ *  x * R mod m with R = 2^(64 * <limbs of m>). A product in this form is reduced by limb-wise
+ *  additions of multiples of m instead of a division, so a chain of multiplications (like a
+ *  modular exponentiation) never divides.
+ *
+ * The values taken by mul(), sqr() and pow() MUST be in Montgomery form, which are the ones
+ *  returned by toMontgomery(), mul(), sqr() and pow().
+ */
+class BigIntMontgomery
+{
+    private:
+        // The modulus, and the number of limbs of it.
+        BigInt modulus;
+        int len;
+        
+        // -m^(-1) mod 2^64.
+        limb_t inverse;
+        
+        // R mod m (the Montgomery form of 1), and R^2 mod m.
+        BigInt one;
+        BigInt rSquare;
+        
+        /*
+         * Multiplies two values in Montgomery form given as limb arrays of <len> limbs.
+         *
+         * Params:
+         *     cand1       -> (in) The first value, which MUST be less than the modulus.
+         *     cand2       -> (in) The second value, which MUST be less than the modulus. If it's the
+         *                     same array as <cand1>, it's squared.
+         *     ret         -> (out) The product, <len> limbs. It MAY be either of the inputs.
+         *     scratch     -> (in) Scratch space of (2 * <len> + 1) limbs.
+         */
+        void mulUtil(const limb_t* cand1, const limb_t* cand2, limb_t* ret, limb_t* scratch) const;
+        
+        /*
+         * Copies a value less than the modulus into a limb array of <len> limbs, padded with zeros.
+         */
+        void padUtil(const BigInt& value, limb_t* ret) const;
+    
+    public:
+        /*
+         * Creates a context for the modulus.
+         *
+         * Param:
+         *     mod     -> (in) The modulus, which MUST be odd and greater than 1.
+         */
+        BigIntMontgomery(const BigInt& mod);
+        
+        /*
+         * Returns the Montgomery form of a value, which is reduced modulo m first (into [0, m), even
+         *  if it's negative).
+         */
+        BigInt toMontgomery(const BigInt& value) const;
+        
+        /*
+         * Returns the value in [0, m) of a Montgomery form.
+         */
+        BigInt fromMontgomery(const BigInt& value) const;
+        
+        /*
+         * Returns the product of two values in Montgomery form, in Montgomery form.
+         */
+        BigInt mul(const BigInt& cand1, const BigInt& cand2) const;
+        
+        /*
+         * Returns the square of a value in Montgomery form, in Montgomery form.
+         */
+        BigInt sqr(const BigInt& cand) const;
+        
+        /*
+         * Raises a value in Montgomery form to a power by sliding-window exponentiation, and returns
+         *  it in Montgomery form.
+         *
+         * Params:
+         *     base    -> (in) The base in Montgomery form.
+         *     exp     -> (in) The exponent, which MUST NOT be negative.
+         *
+         * Returns:
+         *     _ret    -> <base> ^ <exp> in Montgomery form.
+         */
+        BigInt pow(const BigInt& base, const BigInt& exp) const;
+        
+        /*
+         * Returns the modulus.
+         */
+        const BigInt& getModulus() const;
+};
+
+/*
+ * Walks through the primes from a starting value, upward or downward, by a segmented sieve of
+ *  Eratosthenes. The odd values of each segment are crossed out by the small primes, whose positions
+ *  are carried from one segment to the next, so that only the survivors go through the test of
+ *  BigInt::isPrime().
+ *
+ * A sieve holds a segment and the positions, and it's meant to be kept for as many primes as needed.
+ */
+class BigIntPrimeSieve
+{
+    private:
+        // The segment holds the odd values lo, lo + 2, ..., lo + 2 * (count - 1), and whether each of them
+        //  is left by the sieve.
+        BigInt lo;
+        int count;
+        bool* survivors;
+        
+        // The position of the value to be looked at next.
+        int pos;
+        
+        // For each small prime p, the position of the first value of the segment which is a multiple of p.
+        int* offsets;
+        
+        bool downward;
+        
+        // Whether 2 is still to be returned, which is out of the odd values.
+        bool twoPending;
+        
+        BigIntPrimeSieve(const BigIntPrimeSieve&);
+        BigIntPrimeSieve& operator=(const BigIntPrimeSieve&);
+        
+        /*
+         * Sets the offsets for the current segment from the remainders of <lo> modulo the small primes.
+         */
+        void offsetsUtil();
+        
+        /*
+         * Crosses out the multiples of the small primes in the current segment.
+         */
+        void sieveUtil();
+        
+        /*
+         * Moves to the segment next to the current one in the direction of the walk.
+         *
+         * Returns:
+         *     _ret    -> Whether there's such a segment, which is false going downward below 3.
+         */
+        bool advanceUtil();
+        
+        /*
+         * The test of BigInt::isPrime() without the trial division, for an odd value greater than 2.
+         */
+        static bool testUtil(const BigInt& value);
+    
+    public:
+        /*
+         * Creates a sieve starting from a value.
+         *
+         * Params:
+         *     start       -> (in) The first value to be looked at, which is returned by next() if it's a prime.
+         *     downward    -> (in) Whether the primes are walked through downward.
+         */
+        BigIntPrimeSieve(const BigInt& start, bool downward = false);
+        
+        ~BigIntPrimeSieve();
+        
+        /*
+         * Returns the next prime in the direction of the walk. Going downward, 0 is returned once the
+         *  primes run out.
+         */
+        BigInt next();
+};
+
+/*
+ * The lazy expressions built by BigInt::lazy(). Every expression adds (or subtracts) it's value into a
+ *  destination with addTo(), and tells whether it refers to a BigInt with refers().
+ */
+template<class E> class BigIntExpression
+{
+    public:
+        const E& self() const
+        {
+            return static_cast<const E&>(*this);
+        }
+};
+
+class BigIntRef : public BigIntExpression<BigIntRef>
+{
+    private:
+        const BigInt& value;
+    
+    public:
+        explicit BigIntRef(const BigInt& _value) : value(_value) {}
+        
+        const BigInt& get() const
+        {
+            return this->value;
+        }
+        
+        void addTo(BigInt& dest, bool negate) const
+        {
+            if(negate)
+            {
+                dest -= this->value;
+            }
+            else
+            {
+                dest += this->value;
+            }
+        }
+        
+        bool refers(const BigInt& dest) const
+        {
+            return &this->value == &dest;
+        }
+};
+
+/*
+ * The value of an expression as an operand of a product. A wrapped BigInt is used as it is, and
+ *  anything else is evaluated into a BigInt first.
+ */
+template<class E> class BigIntOperand
+{
+    private:
+        BigInt value;
+    
+    public:
+        explicit BigIntOperand(const E& expr)
+        {
+            expr.addTo(this->value, false);
+        }
+        
+        const BigInt& get() const
+        {
+            return this->value;
+        }
+};
+
+template<> class BigIntOperand<BigIntRef>
+{
+    private:
+        const BigInt& value;
+    
+    public:
+        explicit BigIntOperand(const BigIntRef& expr) : value(expr.get()) {}
+        
+        const BigInt& get() const
+        {
+            return this->value;
+        }
+};
+
+template<class L, class R> class BigIntSum : public BigIntExpression<BigIntSum<L, R> >
+{
+    private:
+        L lhs;
+        R rhs;
+        bool subtract;
+    
+    public:
+        BigIntSum(const L& _lhs, const R& _rhs, bool _subtract) : lhs(_lhs), rhs(_rhs), subtract(_subtract) {}
+        
+        void addTo(BigInt& dest, bool negate) const
+        {
+            this->lhs.addTo(dest, negate);
+            this->rhs.addTo(dest, negate ^ this->subtract);
+        }
+        
+        bool refers(const BigInt& dest) const
+        {
+            return this->lhs.refers(dest) || this->rhs.refers(dest);
+        }
+};
+
+template<class L, class R> class BigIntProduct : public BigIntExpression<BigIntProduct<L, R> >
+{
+    private:
+        L lhs;
+        R rhs;
+    
+    public:
+        BigIntProduct(const L& _lhs, const R& _rhs) : lhs(_lhs), rhs(_rhs) {}
+        
+        void addTo(BigInt& dest, bool negate) const
+        {
+            BigIntOperand<L> mult1(this->lhs);
+            BigIntOperand<R> mult2(this->rhs);
+            dest.multiplyAddInPlace(mult1.get(), mult2.get(), negate);
+        }
+        
+        bool refers(const BigInt& dest) const
+        {
+            return this->lhs.refers(dest) || this->rhs.refers(dest);
+        }
+};
+
+inline BigIntRef BigInt::lazy(const BigInt& value)
+{
+    return BigIntRef(value);
+}
+
+template<class E> BigInt::BigInt(const BigIntExpression<E>& expr) : BigInt()
+{
+    expr.self().addTo(*this, false);
+}
+
+template<class E> const BigInt& BigInt::operator=(const BigIntExpression<E>& expr)
+{
+    if(expr.self().refers(*this))
+    {
+        return *this = BigInt(expr);
+    }
+    this->setZero();
+    expr.self().addTo(*this, false);
+    return *this;
+}
+
+template<class E> const BigInt& BigInt::operator+=(const BigIntExpression<E>& expr)
+{
+    if(expr.self().refers(*this))
+    {
+        return *this += BigInt(expr);
+    }
+    expr.self().addTo(*this, false);
+    return *this;
+}
+
+template<class E> const BigInt& BigInt::operator-=(const BigIntExpression<E>& expr)
+{
+    if(expr.self().refers(*this))
+    {
+        return *this -= BigInt(expr);
+    }
+    expr.self().addTo(*this, true);
+    return *this;
+}
+
+template<class L, class R> inline BigIntSum<L, R> operator+(const BigIntExpression<L>& lhs, const BigIntExpression<R>& rhs)
+{
+    return BigIntSum<L, R>(lhs.self(), rhs.self(), false);
+}
+
+template<class L> inline BigIntSum<L, BigIntRef> operator+(const BigIntExpression<L>& lhs, const BigInt& rhs)
+{
+    return BigIntSum<L, BigIntRef>(lhs.self(), BigIntRef(rhs), false);
+}
+
+template<class R> inline BigIntSum<BigIntRef, R> operator+(const BigInt& lhs, const BigIntExpression<R>& rhs)
+{
+    return BigIntSum<BigIntRef, R>(BigIntRef(lhs), rhs.self(), false);
+}
+
+template<class L, class R> inline BigIntSum<L, R> operator-(const BigIntExpression<L>& lhs, const BigIntExpression<R>& rhs)
+{
+    return BigIntSum<L, R>(lhs.self(), rhs.self(), true);
+}
+
+template<class L> inline BigIntSum<L, BigIntRef> operator-(const BigIntExpression<L>& lhs, const BigInt& rhs)
+{
+    return BigIntSum<L, BigIntRef>(lhs.self(), BigIntRef(rhs), true);
+}
+
+template<class R> inline BigIntSum<BigIntRef, R> operator-(const BigInt& lhs, const BigIntExpression<R>& rhs)
+{
+    return BigIntSum<BigIntRef, R>(BigIntRef(lhs), rhs.self(), true);
+}
+
+template<class L, class R> inline BigIntProduct<L, R> operator*(const BigIntExpression<L>& lhs, const BigIntExpression<R>& rhs)
+{
+    return BigIntProduct<L, R>(lhs.self(), rhs.self());
+}
+
+template<class L> inline BigIntProduct<L, BigIntRef> operator*(const BigIntExpression<L>& lhs, const BigInt& rhs)
+{
+    return BigIntProduct<L, BigIntRef>(lhs.self(), BigIntRef(rhs));
+}
+
+template<class R> inline BigIntProduct<BigIntRef, R> operator*(const BigInt& lhs, const BigIntExpression<R>& rhs)
+{
+    return BigIntProduct<BigIntRef, R>(BigIntRef(lhs), rhs.self());
+}
 
 #endif